@@ -0,0 +1,174 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "IDispatcher.h"
+#include "WorkerThread.h"
+
+// Return type of a fire-and-forget coroutine. The coroutine starts on the
+// calling (UI) thread and moves work to the worker with RunOnWorker().
+//
+//     AsyncTask LoadAsync(WorkerThread& worker, std::wstring path)
+//     {
+//         auto entries = co_await RunOnWorker(worker, {}, [path] { return Read(path); });
+//         Show(entries);  // back on the UI thread
+//     }
+//
+// Parameters must be taken by value, the caller returns at the first co_await.
+class AsyncTask {
+public:
+    struct promise_type {
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct WorkerOptions {
+    TaskPriority                priority{TaskPriority::Background};
+    TaskCategory                category{TaskCategory::General};
+    std::optional<TaskViewKey>  viewKey{};
+};
+
+// Runs a function on the worker thread and resumes the awaiting coroutine on
+// the UI thread with its result. The completion travels the usual
+// IAsyncTaskCallback -> IDispatcher::Post route, so there is exactly one hop
+// each way. If the queued step is dropped by ClearPendingTasks, the suspended
+// coroutine is destroyed together with it and never resumes.
+template <typename Function>
+class WorkerAwaiter {
+    using Result = std::invoke_result_t<Function&>;
+    using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, std::optional<Result>>;
+
+public:
+    WorkerAwaiter(WorkerThread& worker, WorkerOptions options, Function function)
+        : _worker(worker), _options(std::move(options)), _function(std::move(function)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        _worker.Enqueue(std::make_unique<Step>(this, handle));
+    }
+
+    Result await_resume()
+    {
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*_result);
+        }
+    }
+
+private:
+    class Step : public IAsyncTask {
+    public:
+        Step(WorkerAwaiter* awaiter, std::coroutine_handle<> handle) : _awaiter(awaiter), _handle(handle) {}
+        ~Step() override
+        {
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        void Execute() override
+        {
+            if constexpr (std::is_void_v<Result>) {
+                _awaiter->_function();
+            } else {
+                _awaiter->_result.emplace(_awaiter->_function());
+            }
+        }
+
+        void OnCompleted() override
+        {
+            std::exchange(_handle, nullptr).resume();
+        }
+
+        TaskPriority GetPriority() const override { return _awaiter->_options.priority; }
+        TaskCategory GetCategory() const override { return _awaiter->_options.category; }
+        std::optional<TaskViewKey> GetViewKey() const override { return _awaiter->_options.viewKey; }
+
+    private:
+        WorkerAwaiter*          _awaiter;
+        std::coroutine_handle<> _handle;
+    };
+
+    WorkerThread&   _worker;
+    WorkerOptions   _options;
+    Function        _function;
+    Storage         _result;
+};
+
+// Defers the rest of the coroutine to a later turn of the UI message loop.
+// Used to hand out results that are already at hand without re-entering the
+// caller, which may be in the middle of a notification handler.
+class DispatcherAwaiter {
+public:
+    explicit DispatcherAwaiter(IDispatcher& dispatcher) : _dispatcher(dispatcher) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        // The posted action owns the coroutine, so a dropped action frees it.
+        struct Owner {
+            std::coroutine_handle<> handle;
+            ~Owner()
+            {
+                if (handle) {
+                    handle.destroy();
+                }
+            }
+        };
+        auto owner = std::make_shared<Owner>();
+        owner->handle = handle;
+        _dispatcher.Post([owner]() {
+            std::exchange(owner->handle, nullptr).resume();
+        });
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    IDispatcher& _dispatcher;
+};
+
+inline DispatcherAwaiter ResumeOnDispatcher(IDispatcher& dispatcher)
+{
+    return DispatcherAwaiter(dispatcher);
+}
+
+template <typename Function>
+WorkerAwaiter<Function> RunOnWorker(WorkerThread& worker, WorkerOptions options, Function function)
+{
+    return WorkerAwaiter<Function>(worker, std::move(options), std::move(function));
+}
@@ -104,6 +104,12 @@ void ComboBox::SetText(const std::wstring& text)
     ::SendMessage(_comboWindow, WM_SETTEXT, 0, reinterpret_cast<LPARAM>(text.c_str()));
 }
 
+void ComboBox::ShowBalloonTip(const std::wstring& title, const std::wstring& text)
+{
+    EDITBALLOONTIP tip = { sizeof(EDITBALLOONTIP), title.c_str(), text.c_str(), TTI_WARNING };
+    Edit_ShowBalloonTip(_editWindow, &tip);
+}
+
 std::wstring ComboBox::GetText() const
 {
     LRESULT len = ::SendMessage(_comboWindow, WM_GETTEXTLENGTH, 0, 0);
@@ -54,6 +54,8 @@ public:
 
     void ClearComboList();
 
+    void ShowBalloonTip(const std::wstring& title, const std::wstring& text);
+
     using KeyPreviewCallback = std::function<bool(HWND, UINT, WPARAM, LPARAM)>;
     void SetKeyPreviewCallback(KeyPreviewCallback callback) { _keyPreviewCallback = callback; }
 
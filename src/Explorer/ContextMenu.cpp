@@ -222,7 +222,7 @@ UINT ContextMenu::ShowContextMenu(HINSTANCE hInst, HWND hWndNpp, HWND hWndParent
     /************************************* modification for notepad ***********************************/
     HMENU   hMainMenu       = ::CreatePopupMenu();
     HMENU   hMenuNppExec    = ::CreatePopupMenu();
-    BOOL    isFolder        = (_entries[0]->FSEntry().IsDirectory());
+    BOOL    isFolder        = (_entries[0]->IsDirectory());
     DWORD   dwExecVer       = 0;
     DWORD   dwExecState     = 0;
     WCHAR   szPath[MAX_PATH];
@@ -302,7 +302,7 @@ UINT ContextMenu::ShowContextMenu(HINSTANCE hInst, HWND hWndNpp, HWND hWndParent
     ::AppendMenu(hMainMenu, MF_STRING, CTX_OPEN_CMD, L"Open Command Window Here");
     // Check if the selected directory (or parent dir if it's a file) is already in workspace folders
     auto path = _strArray[0];
-    if (!_entries[0]->FSEntry().IsDirectory()) {
+    if (!_entries[0]->IsDirectory()) {
         SIZE_T pos = path.rfind(L"\\");
         if (std::wstring::npos != pos) {
             path.erase(pos);
@@ -737,7 +737,7 @@ void ContextMenu::QuickOpen()
     auto path = _strArray[0];
 
     // remove file name
-    if (!_entries[0]->FSEntry().IsDirectory()) {
+    if (!_entries[0]->IsDirectory()) {
         SIZE_T pos = path.rfind(L"\\");
         if (std::wstring::npos != pos) {
             path.erase(pos);
@@ -822,7 +822,7 @@ void ContextMenu::OpenPrompt()
     for (size_t i = 0; i < _strArray.size(); i++) {
         auto path = _strArray[i];
         /* is file */
-        if (!_entries[i]->FSEntry().IsDirectory()) {
+        if (!_entries[i]->IsDirectory()) {
             SIZE_T pos = path.rfind(L'\\');
             if (std::wstring::npos != pos) {
                 path.erase(pos);
@@ -837,7 +837,7 @@ void ContextMenu::AddToWorkspace()
     auto path = _strArray[0];
 
     // remove file name
-    if (!_entries[0]->FSEntry().IsDirectory()) {
+    if (!_entries[0]->IsDirectory()) {
         SIZE_T pos = path.rfind(L"\\");
         if (std::wstring::npos != pos) {
             path.erase(pos);
@@ -875,7 +875,7 @@ void ContextMenu::RemoveFromWorkspace()
     auto path = _strArray[0];
 
     // remove file name
-    if (!_entries[0]->FSEntry().IsDirectory()) {
+    if (!_entries[0]->IsDirectory()) {
         SIZE_T pos = path.rfind(L"\\");
         if (std::wstring::npos != pos) {
             path.erase(pos);
@@ -915,9 +915,9 @@ void ContextMenu::AddToFaves()
 
     /* test if only one file is selected */
     if (_entries.size() > 1) {
-        const bool isFolder = _entries[0]->FSEntry().IsDirectory();
+        const bool isFolder = _entries[0]->IsDirectory();
         for (const auto& entry : _entries) {
-            if (isFolder != entry->FSEntry().IsDirectory()) {
+            if (isFolder != entry->IsDirectory()) {
                 ::MessageBox(_hWndNpp, L"Files and folders cannot be added at the same time!", L"Error", MB_OK);
                 return;
             }
@@ -925,7 +925,7 @@ void ContextMenu::AddToFaves()
         favesDlg.AddToFavorites(isFolder, std::move(_strArray));
     }
     else {
-        bool isFolder = _entries[0]->FSEntry().IsDirectory();
+        bool isFolder = _entries[0]->IsDirectory();
         favesDlg.AddToFavorites(isFolder, _strArray[0]);
     }
 }
@@ -0,0 +1,246 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "DirectoryCache.h"
+#include "FileFilter.h"
+
+#include <algorithm>
+#include <cwctype>
+
+DirectoryCache::DirectoryCache(size_t capacity)
+    : _capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+DirectoryCache::Listing DirectoryCache::Find(const std::wstring& path)
+{
+    const std::wstring key = NormalizeKey(path);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        ++_misses;
+        return nullptr;
+    }
+    ++_hits;
+    _lru.splice(_lru.begin(), _lru, it->second);
+    return it->second->second;
+}
+
+DirectoryCache::Listing DirectoryCache::Peek(const std::wstring& path) const
+{
+    const std::wstring key = NormalizeKey(path);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _index.find(key);
+    return (it != _index.end()) ? it->second->second : nullptr;
+}
+
+uint64_t DirectoryCache::Epoch() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _epoch;
+}
+
+void DirectoryCache::Store(const std::wstring& path, std::vector<FileSystemEntry> entries, uint64_t epoch)
+{
+    const std::wstring key = NormalizeKey(path);
+    auto listing = std::make_shared<const std::vector<FileSystemEntry>>(std::move(entries));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (IsStale(key, epoch)) {
+        return;
+    }
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        it->second->second = std::move(listing);
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return;
+    }
+    _lru.emplace_front(key, std::move(listing));
+    _index.emplace(key, _lru.begin());
+    while (_lru.size() > _capacity) {
+        _index.erase(_lru.back().first);
+        _lru.pop_back();
+    }
+}
+
+void DirectoryCache::Invalidate(const std::wstring& path)
+{
+    const std::wstring key = NormalizeKey(path);
+    std::lock_guard<std::mutex> lock(_mutex);
+    NoteInvalidation(_invalidatedListings, key);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        _lru.erase(it->second);
+        _index.erase(it);
+    }
+    _childrenProbes.erase(key);
+}
+
+void DirectoryCache::InvalidateTree(const std::wstring& path)
+{
+    const std::wstring key = NormalizeKey(path);
+    const std::wstring prefix = key.ends_with(L'\\') ? key : key + L'\\';
+    std::lock_guard<std::mutex> lock(_mutex);
+    NoteInvalidation(_invalidatedTrees, key);
+    for (auto it = _lru.begin(); it != _lru.end();) {
+        if (it->first == key || it->first.starts_with(prefix)) {
+            _index.erase(it->first);
+            it = _lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::erase_if(_childrenProbes, [&](const auto& probe) {
+        return probe.first == key || probe.first.starts_with(prefix);
+    });
+}
+
+void DirectoryCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _clearedEpoch = ++_epoch;
+    _invalidatedListings.clear();
+    _invalidatedTrees.clear();
+    _lru.clear();
+    _index.clear();
+    _childrenProbes.clear();
+}
+
+void DirectoryCache::NoteInvalidation(InvalidationMap& invalidations, const std::wstring& key)
+{
+    ++_epoch;
+    if (_invalidatedListings.size() + _invalidatedTrees.size() >= MAX_INVALIDATIONS) {
+        _invalidatedListings.clear();
+        _invalidatedTrees.clear();
+        _clearedEpoch = _epoch;
+        return;
+    }
+    invalidations[key] = _epoch;
+}
+
+bool DirectoryCache::IsStale(const std::wstring& key, uint64_t epoch) const
+{
+    if (_clearedEpoch > epoch) {
+        return true;
+    }
+    auto it = _invalidatedListings.find(key);
+    if (it != _invalidatedListings.end() && it->second > epoch) {
+        return true;
+    }
+    return std::any_of(_invalidatedTrees.begin(), _invalidatedTrees.end(), [&](const auto& tree) {
+        if (tree.second <= epoch) {
+            return false;
+        }
+        if (key == tree.first) {
+            return true;
+        }
+        return key.starts_with(tree.first) && (tree.first.ends_with(L'\\') || key[tree.first.size()] == L'\\');
+    });
+}
+
+std::optional<bool> DirectoryCache::FindHasChildren(const std::wstring& path, time_t lastWriteTime, bool useFullTree, bool showHidden, uint64_t filterGeneration) const
+{
+    if (lastWriteTime == 0) {
+        return std::nullopt;
+    }
+    const std::wstring key = NormalizeKey(path);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _childrenProbes.find(key);
+    if (it == _childrenProbes.end()) {
+        return std::nullopt;
+    }
+    const ChildrenProbe& probe = it->second;
+    if (probe.lastWriteTime != lastWriteTime || probe.useFullTree != useFullTree || probe.showHidden != showHidden || probe.filterGeneration != filterGeneration) {
+        return std::nullopt;
+    }
+    return probe.hasChildren;
+}
+
+void DirectoryCache::StoreHasChildren(const std::wstring& path, time_t lastWriteTime, bool useFullTree, bool showHidden, uint64_t filterGeneration, bool hasChildren)
+{
+    // Without a time stamp there is no way to tell a stale answer later.
+    if (lastWriteTime == 0) {
+        return;
+    }
+    const std::wstring key = NormalizeKey(path);
+    std::lock_guard<std::mutex> lock(_mutex);
+    // A probe that was running while the filter changed answered for the old one
+    if (filterGeneration < _filterGeneration) {
+        return;
+    }
+    if (_childrenProbes.size() >= MAX_CHILDREN_PROBES) {
+        _childrenProbes.clear();
+    }
+    _childrenProbes[key] = { lastWriteTime, useFullTree, showHidden, filterGeneration, hasChildren };
+}
+
+void DirectoryCache::ClearHasChildren(uint64_t filterGeneration)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _filterGeneration = std::max(_filterGeneration, filterGeneration);
+    _childrenProbes.clear();
+}
+
+std::vector<FileSystemEntry> DirectoryCache::ReadListing(const std::wstring& path)
+{
+    return FileSystemService::GetDirectoryEntries(path, true, true);
+}
+
+std::vector<FileSystemEntry> DirectoryCache::Select(std::span<const FileSystemEntry> listing, bool showHidden, bool includeParent)
+{
+    std::vector<FileSystemEntry> entries;
+    entries.reserve(listing.size());
+    for (const auto& entry : listing) {
+        if (entry.IsParent() ? !includeParent : (entry.IsHidden() && !showHidden)) {
+            continue;
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+bool DirectoryCache::HasChildren(const std::wstring& path, const std::vector<FileSystemEntry>& listing, bool useFullTree, bool showHidden, const FileFilter& filter)
+{
+    return std::any_of(listing.begin(), listing.end(), [&](const FileSystemEntry& entry) {
+        if (entry.IsParent() || (entry.IsHidden() && !showHidden)) {
+            return false;
+        }
+        if (entry.IsDirectory()) {
+            return !filter.isExcludedDirectory(path, entry.Name());
+        }
+        return useFullTree && filter.match(path, entry.Name());
+    });
+}
+
+std::wstring DirectoryCache::NormalizeKey(const std::wstring& path)
+{
+    std::wstring key = path;
+    std::replace(key.begin(), key.end(), L'/', L'\\');
+    // Keep the separator of a drive root ("C:\") but drop it elsewhere.
+    while (key.size() > 3 && key.back() == L'\\') {
+        key.pop_back();
+    }
+    std::transform(key.begin(), key.end(), key.begin(), [](wchar_t ch) {
+        return static_cast<wchar_t>(std::towlower(ch));
+    });
+    return key;
+}
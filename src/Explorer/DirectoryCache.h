@@ -0,0 +1,138 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileSystemService.h"
+
+/// @brief Bounded LRU cache of raw directory listings, keyed by normalized path.
+///
+/// A listing holds every entry of the directory, including hidden ones and
+/// the ".." entry, so that it serves all view settings. Use Select() to
+/// reduce it to what the view wants. The cache is thread-safe: listings are
+/// read on the UI thread, stored by the worker and invalidated by the
+/// directory watcher thread.
+class DirectoryCache {
+public:
+    using Listing = std::shared_ptr<const std::vector<FileSystemEntry>>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit DirectoryCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /// @brief Returns the cached listing of @p path and counts a hit or a miss.
+    Listing Find(const std::wstring& path);
+
+    /// @brief Returns the cached listing of @p path without touching the
+    ///        counters or the LRU order.
+    Listing Peek(const std::wstring& path) const;
+
+    /// @brief Epoch to pass to Store() for a listing read from disk after this call.
+    uint64_t Epoch() const;
+
+    /// @brief Stores a listing read from disk. The listing is dropped if @p path
+    ///        (or a folder above it) was invalidated since @p epoch, as it may
+    ///        already be stale. Changes elsewhere do not affect it.
+    void Store(const std::wstring& path, std::vector<FileSystemEntry> entries, uint64_t epoch);
+
+    /// @brief Drops the listing of @p path.
+    void Invalidate(const std::wstring& path);
+
+    /// @brief Drops the listings of @p path and all of its descendants.
+    void InvalidateTree(const std::wstring& path);
+
+    void Clear();
+
+    /// @brief Returns the remembered has-children answer for a directory whose
+    ///        last write time is still @p lastWriteTime, given under the filter
+    ///        of @p filterGeneration (FileFilter::getGeneration()).
+    std::optional<bool> FindHasChildren(const std::wstring& path, time_t lastWriteTime, bool useFullTree, bool showHidden, uint64_t filterGeneration) const;
+
+    /// @brief Remembers an answer computed under the filter of @p filterGeneration.
+    ///        Answers of a filter older than the last ClearHasChildren() are dropped.
+    void StoreHasChildren(const std::wstring& path, time_t lastWriteTime, bool useFullTree, bool showHidden, uint64_t filterGeneration, bool hasChildren);
+
+    /// @brief Forgets all has-children answers after the filter changed to @p filterGeneration.
+    void ClearHasChildren(uint64_t filterGeneration);
+
+    uint64_t Hits() const { return _hits.load(); }
+    uint64_t Misses() const { return _misses.load(); }
+
+    /// @brief Reads the raw listing of @p path from disk, suitable for Store().
+    static std::vector<FileSystemEntry> ReadListing(const std::wstring& path);
+
+    /// @brief Filters a raw listing by the view settings.
+    static std::vector<FileSystemEntry> Select(std::span<const FileSystemEntry> listing, bool showHidden, bool includeParent);
+
+    /// @brief Answers FileSystemService::HaveChildren() from the raw listing of @p path.
+    static bool HasChildren(const std::wstring& path, const std::vector<FileSystemEntry>& listing, bool useFullTree, bool showHidden, const FileFilter& filter);
+
+private:
+    static std::wstring NormalizeKey(const std::wstring& path);
+
+    // All of these expect _mutex to be held.
+    using InvalidationMap = std::unordered_map<std::wstring, uint64_t>;
+    void NoteInvalidation(InvalidationMap& invalidations, const std::wstring& key);
+    bool IsStale(const std::wstring& key, uint64_t epoch) const;
+
+    using LruList = std::list<std::pair<std::wstring, Listing>>;
+
+    // Once this many invalidations are remembered, they are folded into one
+    // cache-wide invalidation.
+    static constexpr size_t MAX_INVALIDATIONS = 4096;
+
+    // Has-children answers are tiny; the table is simply emptied when full.
+    static constexpr size_t MAX_CHILDREN_PROBES = 16384;
+    struct ChildrenProbe {
+        time_t      lastWriteTime;
+        bool        useFullTree;
+        bool        showHidden;
+        uint64_t    filterGeneration;
+        bool        hasChildren;
+    };
+
+    size_t                                              _capacity;
+    LruList                                             _lru;
+    std::unordered_map<std::wstring, LruList::iterator> _index;
+    std::unordered_map<std::wstring, ChildrenProbe>     _childrenProbes;
+    uint64_t                                            _filterGeneration{0};
+    uint64_t                                            _epoch{0};
+    // Epoch of the last invalidation of a listing, of a subtree and of the whole cache
+    InvalidationMap                                     _invalidatedListings;
+    InvalidationMap                                     _invalidatedTrees;
+    uint64_t                                            _clearedEpoch{0};
+    mutable std::mutex                                  _mutex;
+    std::atomic<uint64_t>                               _hits{0};
+    std::atomic<uint64_t>                               _misses{0};
+};
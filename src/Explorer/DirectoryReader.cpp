@@ -23,12 +23,14 @@
 */
 
 #include "DirectoryReader.h"
+#include "FileFilter.h"
 
 #include <utility>
 
 DirectoryReader::DirectoryReader()
     : _needsStop(false)
     , _reading(false)
+    , _filter(nullptr)
 {
 
 }
@@ -112,6 +114,9 @@ bool DirectoryReader::ReadDirRecursive(const std::filesystem::path& path)
                 else if ('$' == name[0]) {
                     // skip system directory
                 }
+                else if (_filter != nullptr && _filter->isExcludedDirectory(path.native(), name)) {
+                    // skip directory excluded by the file filter
+                }
                 else {
                     ReadDirRecursive(it->path());
                 }
@@ -137,6 +142,11 @@ void DirectoryReader::Cancel()
     }
 }
 
+void DirectoryReader::SetFilter(const FileFilter* filter)
+{
+    _filter = filter;
+}
+
 const std::filesystem::path& DirectoryReader::GetRootPath() const
 {
     return _rootPath;
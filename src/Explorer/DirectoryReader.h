@@ -27,6 +27,8 @@
 #include <functional>
 #include <thread>
 
+class FileFilter;
+
 class DirectoryReader
 {
 public:
@@ -37,12 +39,14 @@ public:
     void ReadDir(const std::filesystem::path& rootPath, ReadDirCallback readDirCallback, ReadDirFinCallback readDirFinCallback);
     void ReadDirs(const std::vector<std::filesystem::path>& rootPaths, ReadDirCallback readDirCallback, ReadDirFinCallback readDirFinCallback);
     void Cancel();
+    void SetFilter(const FileFilter* filter);
     const std::filesystem::path& GetRootPath() const;
     bool IsReading() const;
 private:
     bool                    _needsStop;
     bool                    _reading;
     std::filesystem::path   _rootPath;
+    const FileFilter*       _filter;
     std::thread             _workerThread;
     ReadDirCallback         _readDirCallback;
     ReadDirFinCallback      _readDirFinCallback;
@@ -27,6 +27,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <shlobj.h>
 #include <dbt.h>
 #include <ranges>
+#include <unordered_map>
+#include <unordered_set>
 #include <format>
 #include <wrl/client.h>
 
@@ -36,6 +38,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "QuickOpenDialog.h"
 #include "OptionDialog.h"
 #include "HelpDialog.h"
+#include "IconIndexCache.h"
+#include "PathTable.h"
 #include "ThemeRenderer.h"
 #include "../NppPlugin/PluginInterface.h"
 #include "../NppPlugin/menuCmdID.h"
@@ -108,8 +112,17 @@ WNDPROC             wndProcNotepad      = nullptr;
 std::vector<DrvMap> gvDrvMap;
 HIMAGELIST          ghImgList           = nullptr;
 
-/* current open docs */
-std::vector<std::wstring>   g_openedFilePaths;
+/* current open docs: the name and long path of each Notepad++ buffer and the set of those paths */
+struct OpenedBuffer {
+    std::wstring    fileName;
+    PathId          id;
+};
+std::unordered_map<UINT_PTR, OpenedBuffer>  g_openedBuffers;
+std::unordered_multiset<PathId>             g_openedFilePaths;
+
+void UpdateOpenedBuffer(UINT_PTR bufferId);
+void RemoveOpenedBuffer(UINT_PTR bufferId);
+void SyncOpenedBuffers();
 
 void UpdateThemeColor();
 
@@ -213,8 +226,14 @@ extern "C" __declspec(dllexport) void beNotified(SCNotification *notifyCode)
         }
         UpdateDocs();
         break;
-    case NPPN_FILECLOSED:
     case NPPN_FILEOPENED:
+    case NPPN_FILESAVED:
+    case NPPN_FILERENAMED:
+        UpdateOpenedBuffer(notifyCode->nmhdr.idFrom);
+        UpdateDocs();
+        break;
+    case NPPN_FILECLOSED:
+        RemoveOpenedBuffer(notifyCode->nmhdr.idFrom);
         UpdateDocs();
         break;
     case NPPN_TBMODIFICATION: {
@@ -241,6 +260,7 @@ extern "C" __declspec(dllexport) void beNotified(SCNotification *notifyCode)
         break;
     }
     case NPPN_READY:
+        SyncOpenedBuffers();
         UpdateThemeColor();
         explorerDlg.InitFinish();
         favesDlg.InitFinish();
@@ -508,23 +528,35 @@ HIMAGELIST GetSmallImageList(BOOL bSystem)
 
 void GetIcons(const std::wstring& path, DWORD attributes, LPINT piIconNormal, LPINT piIconSelected, LPINT piIconOverlayed)
 {
-    SHFILEINFO sfi{};
-    if (::SHGetFileInfo(path.c_str(), attributes, &sfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX | SHGFI_SMALLICON)) {
-        if (piIconNormal != nullptr) {
-            *piIconNormal = sfi.iIcon & 0x00ffffff;
-        }
-        if (piIconOverlayed != nullptr) {
-            *piIconOverlayed = sfi.iIcon >> 24;
+    /* with SHGFI_USEFILEATTRIBUTES the result only depends on the file type */
+    IconIndexCache& cache = IconIndexCache::Instance();
+    const auto key = IconIndexCache::MakeKey(path, (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0, IconIndexCache::Lookup::SystemIndex);
+    std::optional<IconIndices> indices = key ? cache.Find(*key) : std::nullopt;
+
+    if (!indices) {
+        SHFILEINFO sfi{};
+        if (!::SHGetFileInfo(path.c_str(), attributes, &sfi, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX | SHGFI_SMALLICON)) {
+            return;
         }
-    }
+        indices = IconIndices{ sfi.iIcon & 0x00ffffff, sfi.iIcon & 0x00ffffff, sfi.iIcon >> 24 };
 
-    if (piIconSelected != nullptr) {
         SHFILEINFO sfiOpen{};
         if (::SHGetFileInfo(path.c_str(), attributes, &sfiOpen, sizeof(SHFILEINFO), SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX | SHGFI_SMALLICON | SHGFI_OPENICON)) {
-            *piIconSelected = sfiOpen.iIcon & 0x00ffffff;
-        } else if (piIconNormal != nullptr) {
-            *piIconSelected = *piIconNormal;
+            indices->selected = sfiOpen.iIcon & 0x00ffffff;
         }
+        if (key) {
+            cache.Store(*key, *indices);
+        }
+    }
+
+    if (piIconNormal != nullptr) {
+        *piIconNormal = indices->normal;
+    }
+    if (piIconSelected != nullptr) {
+        *piIconSelected = indices->selected;
+    }
+    if (piIconOverlayed != nullptr) {
+        *piIconOverlayed = indices->overlay;
     }
 }
 
@@ -620,13 +652,50 @@ void FetchIcons(LPCTSTR currentPath, LPCTSTR fileName, DevType type, LPINT piIco
             }
         }
         else {
-            ::ZeroMemory(&sfi, sizeof(SHFILEINFO));
-            SHGetFileInfo(TEMP,
-                FILE_ATTRIBUTE_NORMAL,
-                &sfi,
-                sizeof(SHFILEINFO),
-                SHGFI_ICON | SHGFI_SMALLICON | stOverlay | SHGFI_USEFILEATTRIBUTES);
-            ::DestroyIcon(sfi.hIcon);
+            /* a file icon only depends on the extension, ask the shell once per type */
+            IconIndexCache& cache = IconIndexCache::Instance();
+            const auto key = IconIndexCache::MakeKey(TEMP, false, IconIndexCache::Lookup::SmallIcon);
+            if (key) {
+                auto cached = cache.Find(*key);
+                if (!cached) {
+                    /* the type alone has no overlay, only the index is needed */
+                    ::ZeroMemory(&sfi, sizeof(SHFILEINFO));
+                    if (SHGetFileInfo(TEMP,
+                        FILE_ATTRIBUTE_NORMAL,
+                        &sfi,
+                        sizeof(SHFILEINFO),
+                        SHGFI_SYSICONINDEX | SHGFI_SMALLICON | SHGFI_USEFILEATTRIBUTES)) {
+                        const int icon = sfi.iIcon & 0x00ffffff;
+                        cached = IconIndices{ icon, icon, 0 };
+                        cache.Store(*key, *cached);
+                    }
+                }
+                if (cached) {
+                    *piIconNormal   = cached->normal;
+                    *piIconSelected = cached->selected;
+                    if (piIconOverlayed != nullptr) {
+                        /* the overlay belongs to this file, not to its type */
+                        ::ZeroMemory(&sfi, sizeof(SHFILEINFO));
+                        SHGetFileInfo(TEMP,
+                            0,
+                            &sfi,
+                            sizeof(SHFILEINFO),
+                            SHGFI_ICON | SHGFI_SMALLICON | SHGFI_OVERLAYINDEX);
+                        ::DestroyIcon(sfi.hIcon);
+                        *piIconOverlayed = sfi.iIcon >> 24;
+                    }
+                    return;
+                }
+            }
+            else {
+                ::ZeroMemory(&sfi, sizeof(SHFILEINFO));
+                SHGetFileInfo(TEMP,
+                    FILE_ATTRIBUTE_NORMAL,
+                    &sfi,
+                    sizeof(SHFILEINFO),
+                    SHGFI_ICON | SHGFI_SMALLICON | stOverlay | SHGFI_USEFILEATTRIBUTES);
+                ::DestroyIcon(sfi.hIcon);
+            }
         }
 
         *piIconNormal = sfi.iIcon & 0x00ffffff;
@@ -671,51 +740,73 @@ void UpdateDocs()
         explorerDlg.NotifyNewFile();
         favesDlg.NotifyNewFile();
 
-        std::vector<std::wstring> fileNames;
-        if (g_nppContext.GetOpenFileNames(fileNames)) {
-            if (explorerDlg.isVisible() || favesDlg.isVisible()) {
-                /* update documents list */
-                g_openedFilePaths.clear();
-                for (const auto& fileName : fileNames) {
-                    WCHAR pszLongName[MAX_PATH];
-                    if (GetLongPathName(fileName.c_str(), pszLongName, MAX_PATH) != 0) {
-                        g_openedFilePaths.push_back(pszLongName);
-                    }
-                }
-            }
-            if (explorerDlg.isVisible()) {
-                RedrawWindow(explorerDlg.getHSelf(), nullptr, nullptr, TRUE);
-            }
-            if (favesDlg.isVisible()) {
-                RedrawWindow(favesDlg.getHSelf(), nullptr, nullptr, TRUE);
-            }
+        /* the documents list is kept up to date by the file notifications */
+        if (explorerDlg.isVisible()) {
+            RedrawWindow(explorerDlg.getHSelf(), nullptr, nullptr, TRUE);
+        }
+        if (favesDlg.isVisible()) {
+            RedrawWindow(favesDlg.getHSelf(), nullptr, nullptr, TRUE);
         }
     }
 }
 
-void UpdateCurrUsedDocs(LPTSTR* pFiles, UINT numFiles)
+PathId LongPathId(const std::wstring& fileName)
 {
+    /* unsaved documents have no long path, they are asked again when saved */
     WCHAR pszLongName[MAX_PATH];
+    if (fileName.empty() || GetLongPathName(fileName.c_str(), pszLongName, MAX_PATH) == 0) {
+        return INVALID_PATH_ID;
+    }
+    return PathTable::Instance().Intern(pszLongName);
+}
 
-    /* clear old elements */
-    g_openedFilePaths.clear();
+void UpdateOpenedBuffer(UINT_PTR bufferId)
+{
+    std::wstring fileName = g_nppContext.GetFullPathFromBufferId(bufferId);
+
+    /* saved under the same name, nothing changed */
+    auto it = g_openedBuffers.find(bufferId);
+    if (it != g_openedBuffers.end() && it->second.fileName == fileName) {
+        return;
+    }
+    RemoveOpenedBuffer(bufferId);
+
+    PathId id = LongPathId(fileName);
+    if (id != INVALID_PATH_ID) {
+        g_openedBuffers.emplace(bufferId, OpenedBuffer{ std::move(fileName), id });
+        g_openedFilePaths.insert(id);
+    }
+}
 
-    for (UINT i = 0; i < numFiles; i++) {
-        /* store only long pathes */
-        if (GetLongPathName(pFiles[i], pszLongName, MAX_PATH) != 0) {
-            g_openedFilePaths.push_back(pszLongName);
+void RemoveOpenedBuffer(UINT_PTR bufferId)
+{
+    auto it = g_openedBuffers.find(bufferId);
+    if (it != g_openedBuffers.end()) {
+        g_openedFilePaths.erase(g_openedFilePaths.find(it->second.id));
+        g_openedBuffers.erase(it);
+    }
+}
+
+/* picks up documents that were opened before the plugin got notified */
+void SyncOpenedBuffers()
+{
+    g_openedBuffers.clear();
+    g_openedFilePaths.clear();
+    for (UINT_PTR bufferId : g_nppContext.GetOpenBufferIds()) {
+        if (!g_openedBuffers.contains(bufferId)) {
+            UpdateOpenedBuffer(bufferId);
         }
     }
 }
 
 BOOL IsFileOpen(const std::wstring &filePath)
 {
-    for (const auto &openedFilePath : g_openedFilePaths) {
-        if (openedFilePath == filePath) {
-            return TRUE;
-        }
+    /* a path that was never interned cannot be open */
+    const PathId fileId = PathTable::Instance().Find(filePath);
+    if (fileId == INVALID_PATH_ID) {
+        return FALSE;
     }
-    return FALSE;
+    return g_openedFilePaths.contains(fileId) ? TRUE : FALSE;
 }
 
 // compare arguments and convert
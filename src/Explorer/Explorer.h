@@ -117,7 +117,6 @@ void FetchIcons(LPCTSTR currentPath, LPCTSTR fileName, DevType type, LPINT iIcon
 
 /* current open files */
 void UpdateDocs();
-void UpdateCurrUsedDocs(LPTSTR *ppFiles, UINT numFiles);
 BOOL IsFileOpen(const std::wstring& filePath);
 
 /* scroll up/down test function */
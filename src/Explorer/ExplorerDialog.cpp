@@ -105,7 +105,6 @@ ExplorerDialog::ExplorerDialog()
     : DockingDlgInterface(IDD_EXPLORER_DLG)
     , _model(std::make_shared<ExplorerModel>())
     , _viewModel(std::make_shared<ExplorerViewModel>(_model, nullptr, this))
-    , _pendingSelectRootItem(nullptr)
     , _bStartupFinish(FALSE)
     , _hItemExpand(nullptr)
     , _hDefaultTreeProc(nullptr)
@@ -291,7 +290,10 @@ INT_PTR CALLBACK ExplorerDialog::run_dlgProc(UINT Message, WPARAM wParam, LPARAM
                 const HTREEITEM item = _hTreeCtrl.HitTest(&ht);
                 if (item != nullptr) {
                     auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(item));
-                    if (pShared != nullptr && *pShared != nullptr && !(*pShared)->FSEntry().IsDirectory()) {
+                    if (pShared == nullptr) {
+                        EditTreeChildFilter(item);
+                    }
+                    else if (*pShared != nullptr && !(*pShared)->IsDirectory()) {
                         _pluginContext->DoOpen((*pShared)->Path());
                     }
                 }
@@ -322,7 +324,7 @@ INT_PTR CALLBACK ExplorerDialog::run_dlgProc(UINT Message, WPARAM wParam, LPARAM
                 if (item != nullptr) {
                     std::filesystem::path path = GetPath(item);
                     auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(item));
-                    if (pShared != nullptr && *pShared != nullptr && (*pShared)->FSEntry().IsDirectory()) {
+                    if (pShared != nullptr && *pShared != nullptr && (*pShared)->IsDirectory()) {
                         _pendingNavigateDir = path;
                     }
                     else {
@@ -353,11 +355,42 @@ INT_PTR CALLBACK ExplorerDialog::run_dlgProc(UINT Message, WPARAM wParam, LPARAM
             }
             case TVN_DELETEITEM: {
                 LPNMTREEVIEW pnm = (LPNMTREEVIEW)lParam;
+                UnindexTreeItem(pnm->itemOld.hItem);
+                _treeChildPages.erase(pnm->itemOld.hItem);
+                _queuedProbes.erase(pnm->itemOld.hItem);
                 if (pnm->itemOld.lParam != 0) {
                     delete reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(pnm->itemOld.lParam);
                 }
                 break;
             }
+            case TVN_BEGINLABELEDIT: {
+                /* only the "more" item is edited: its label is the name filter of the node */
+                LPNMTVDISPINFO pdi = (LPNMTVDISPINFO)lParam;
+                const bool isMoreItem = (_hTreeCtrl.GetParam(pdi->item.hItem) == nullptr);
+                if (isMoreItem) {
+                    HWND hEdit = _hTreeCtrl.GetEditControl();
+                    ::SetWindowText(hEdit, GetTreeChildFilter(_hTreeCtrl.GetParent(pdi->item.hItem)).c_str());
+                    ::SendMessage(hEdit, EM_SETSEL, 0, -1);
+                }
+                ::SetWindowLongPtr(_hSelf, DWLP_MSGRESULT, isMoreItem ? FALSE : TRUE);
+                return TRUE;
+            }
+            case TVN_ENDLABELEDIT: {
+                /* the label is rewritten by the sync, which must not run inside the notification */
+                LPNMTVDISPINFO pdi = (LPNMTVDISPINFO)lParam;
+                const HTREEITEM hParent = _hTreeCtrl.GetParent(pdi->item.hItem);
+                auto indexed = _pathsByTreeItem.find(hParent);
+                if (pdi->item.pszText != nullptr && indexed != _pathsByTreeItem.end()) {
+                    Post([this, hParent, path = indexed->second, filter = std::wstring(pdi->item.pszText)] {
+                        auto current = _pathsByTreeItem.find(hParent);
+                        if (current != _pathsByTreeItem.end() && current->second == path) {
+                            FilterTreeChildren(hParent, filter);
+                        }
+                    });
+                }
+                ::SetWindowLongPtr(_hSelf, DWLP_MSGRESULT, FALSE);
+                return TRUE;
+            }
             case TVN_BEGINDRAG: {
                 CIDropSource dropSrc;
                 CIDataObject dataObj(&dropSrc);
@@ -463,8 +496,21 @@ INT_PTR CALLBACK ExplorerDialog::run_dlgProc(UINT Message, WPARAM wParam, LPARAM
         else {
             _FileList.filterFiles(L"*");
         }
-        if (_pSettings->IsUseFullTree()) {
-            RefreshTreeFilter();
+        RefreshTreeFilter();
+
+        /* folder rules hide folders only in the deny list, tell once per filter that others are ignored */
+        const FileFilter& filter = _pSettings->GetFileFilter();
+        if (filter.getIgnoredRules().empty()) {
+            _warnedFilter.clear();
+        }
+        else if (_warnedFilter != filter.getFilterString()) {
+            _warnedFilter = filter.getFilterString();
+            std::wstring rules;
+            for (const auto& rule : filter.getIgnoredRules()) {
+                rules += (rules.empty() ? L"" : L"; ") + rule;
+            }
+            _ComboFilter.ShowBalloonTip(L"Folder rules ignored",
+                std::format(L"Allowing folders is not supported, so \"{}\" has no effect. Put folder rules in [^...] to hide folders.", rules));
         }
         return TRUE;
     }
@@ -551,7 +597,7 @@ LRESULT ExplorerDialog::RunTreeProc(HWND hwnd, UINT Message, WPARAM wParam, LPAR
             HTREEITEM hItem = _hTreeCtrl.GetSelection();
             auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
             if (pShared != nullptr && *pShared != nullptr) {
-                if ((*pShared)->FSEntry().IsDirectory()) {
+                if ((*pShared)->IsDirectory()) {
                     if (_hTreeCtrl.GetChild(hItem) == nullptr) {
                         FetchChildren(hItem);
                     }
@@ -561,6 +607,9 @@ LRESULT ExplorerDialog::RunTreeProc(HWND hwnd, UINT Message, WPARAM wParam, LPAR
                     _pluginContext->DoOpen((*pShared)->Path());
                 }
             }
+            else if (pShared == nullptr && hItem != nullptr) {
+                EditTreeChildFilter(hItem);
+            }
             return TRUE;
         }
         case VK_TAB:
@@ -974,54 +1023,17 @@ BOOL ExplorerDialog::SelectItem(const std::filesystem::path& path)
     /* disabled detection of TVN_SELCHANGED notification */
     _isSelNotifyEnable = FALSE;
 
-    // Scan all root nodes in the tree control to check if the target path falls under one of them
-    HTREEITEM hMatchedRoot = nullptr;
-    std::wstring matchedRootPath;
-
-    HTREEITEM hItem = _hTreeCtrl.GetRoot();
-    while (hItem != nullptr) {
-        std::wstring rootPath = GetPath(hItem);
-        // Normalize trailing slashes for comparison
-        std::wstring cleanRoot = rootPath;
-        if (!cleanRoot.empty() && cleanRoot.back() == L'\\') cleanRoot.pop_back();
-        std::wstring cleanTarget = longPath.wstring();
-        if (!cleanTarget.empty() && cleanTarget.back() == L'\\') cleanTarget.pop_back();
-
-        // Check if cleanTarget starts with cleanRoot
-        bool isMatch = false;
-        if (_wcsicmp(cleanTarget.c_str(), cleanRoot.c_str()) == 0) {
-            isMatch = true;
-        } else {
-            std::wstring cleanRootWithSlash = cleanRoot + L"\\";
-            if (cleanTarget.size() > cleanRootWithSlash.size() &&
-                _wcsnicmp(cleanTarget.c_str(), cleanRootWithSlash.c_str(), cleanRootWithSlash.size()) == 0) {
-                isMatch = true;
-            }
-        }
-
-        if (isMatch) {
-            if (hMatchedRoot == nullptr || rootPath.size() > matchedRootPath.size()) {
-                hMatchedRoot = hItem;
-                matchedRootPath = rootPath;
-            }
-        }
-        hItem = _hTreeCtrl.GetNextItem(hItem, TVGN_NEXT);
-    }
-
-    std::vector<std::wstring> pathSegments;
-    size_t skipSegments = 0;
+    // A path outside of all root nodes can only be reached through a UNC root, which is mounted on demand
+    PathTable& pathTable = PathTable::Instance();
+    const PathId targetId = pathTable.Intern(longPath.wstring());
 
-    if (hMatchedRoot != nullptr) {
-        _pendingSelectRootItem = hMatchedRoot;
-        for (const auto& segment : std::filesystem::path(matchedRootPath)) {
-            if (segment != L"" && segment != L"\\") {
-                skipSegments++;
-            }
-        }
+    bool isUnderRoot = false;
+    for (HTREEITEM hItem = _hTreeCtrl.GetRoot(); hItem != nullptr && !isUnderRoot; hItem = _hTreeCtrl.GetNextItem(hItem, TVGN_NEXT)) {
+        auto rootId = _pathsByTreeItem.find(hItem);
+        isUnderRoot = (rootId != _pathsByTreeItem.end() && pathTable.IsSameOrDescendant(targetId, rootId->second));
     }
-    else {
-        _pendingSelectRootItem = nullptr;
 
+    if (!isUnderRoot) {
         // Fallback UNC check and mount
         HTREEITEM hFallbackItem = _hTreeCtrl.GetRoot();
         if (longPath.wstring().compare(0, 2, L"\\\\") == 0) {
@@ -1043,23 +1055,14 @@ BOOL ExplorerDialog::SelectItem(const std::filesystem::path& path)
                 hFallbackItem = _hTreeCtrl.GetNextItem(hFallbackItem, TVGN_NEXT);
                 if (hFallbackItem == nullptr) {
                     std::wstring rootStr = std::filesystem::path(longPath).root_name().wstring();
-                    auto rootEntry = std::make_shared<ExplorerEntry>(rootStr, FileSystemEntry(rootStr, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
+                    auto rootEntry = ExplorerEntry::Create(rootStr, FileSystemEntry(rootStr, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
                     InsertChildFolder(rootEntry, TVI_ROOT, TVI_LAST, TRUE, FALSE, TRUE);
                 }
             } while (hFallbackItem != nullptr);
         }
     }
 
-    size_t idx = 0;
-    for (const auto& segment : longPath) {
-        if (segment != L"" && segment != L"\\") {
-            if (idx >= skipSegments) {
-                pathSegments.push_back(segment.wstring());
-            }
-            idx++;
-        }
-    }
-    _pendingSelectPathSegments = std::move(pathSegments);
+    _pendingSelectPath = targetId;
 
     ResumePendingSelection();
 
@@ -1068,122 +1071,92 @@ BOOL ExplorerDialog::SelectItem(const std::filesystem::path& path)
 
 void ExplorerDialog::ResumePendingSelection()
 {
-    if (_pendingSelectPathSegments.empty()) {
-        if (_pendingSelectRootItem != nullptr && _pendingSelectRootItem != TVI_ROOT) {
-            _hTreeCtrl.SelectItem(_pendingSelectRootItem);
-            _hTreeCtrl.EnsureVisible(_pendingSelectRootItem);
-            updateDockingDlg();
-            _pendingSelectRootItem = nullptr;
-            _isSelNotifyEnable = TRUE;
-        }
+    if (_pendingSelectPath == INVALID_PATH_ID) {
         return;
     }
 
-    HTREEITEM hParent = (_pendingSelectRootItem != nullptr) ? _pendingSelectRootItem : TVI_ROOT;
-    HTREEITEM hItem = _hTreeCtrl.GetChild(hParent);
-
-    if (hItem == nullptr) {
-        bool isLoaded = false;
-        if (hParent == TVI_ROOT) {
-            isLoaded = true; // roots are loaded synchronously
-        } else {
-            auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hParent));
-            isLoaded = (pShared != nullptr && *pShared != nullptr && (*pShared)->HasLoadedChildren());
-        }
+    PathTable& pathTable = PathTable::Instance();
 
-        if (!isLoaded) {
-            _hTreeCtrl.SelectItem(hParent);
-            FetchChildren(hParent);
-            return;
-        }
+    // The deepest folder on the way to the target that is already in the tree
+    PathId itemPath = _pendingSelectPath;
+    HTREEITEM hItem = FindTreeItemByPathId(itemPath);
+    while (hItem == nullptr && itemPath != INVALID_PATH_ID) {
+        itemPath = pathTable.Parent(itemPath);
+        hItem = FindTreeItemByPathId(itemPath);
     }
 
-    HTREEITEM hItemSel = nullptr;
-    bool isRootSegment = (hParent == TVI_ROOT);
-    size_t segmentIdx = 0;
-
-    while (hItem != nullptr && segmentIdx < _pendingSelectPathSegments.size()) {
-        auto itemName = _hTreeCtrl.GetItemText(hItem);
-
-        /* truncate item name if we are in root */
-        if (isRootSegment && (('A' <= itemName[0]) && (itemName[0] <= 'Z'))) {
-            itemName.resize(2);
+    if (hItem != nullptr && itemPath == _pendingSelectPath) {
+        _hTreeCtrl.SelectItem(hItem);
+        _hTreeCtrl.EnsureVisible(hItem);
+        updateDockingDlg();
+    }
+    else if (hItem != nullptr) {
+        // The next folder to go down into
+        PathId childPath = _pendingSelectPath;
+        while (pathTable.Parent(childPath) != itemPath) {
+            childPath = pathTable.Parent(childPath);
+        }
+
+        // If it is a UNC server node, the share is not listed as a child:
+        // insert it dynamically and continue below it
+        if (FileSystemService::IsUncServerPath(GetPath(hItem))) {
+            const std::wstring childSegment = pathTable.Name(childPath);
+            std::wstring sharePath = FileSystemService::CombinePath(GetPath(hItem), childSegment);
+            auto shareEntry = ExplorerEntry::Create(sharePath, FileSystemEntry(childSegment, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
+            if (InsertChildFolder(shareEntry, hItem, TVI_LAST, TRUE, FALSE, TRUE) != nullptr) {
+                // Add to parent ExplorerEntry's children
+                auto* pParentShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
+                if (pParentShared != nullptr && *pParentShared != nullptr) {
+                    auto parentEntry = *pParentShared;
+                    auto children = parentEntry->Children();
+                    children.push_back(shareEntry);
+                    parentEntry->SetChildren(children);
+                }
+                ResumePendingSelection();
+                return;
+            }
         }
-
-        const std::wstring& segment = _pendingSelectPathSegments[segmentIdx];
-        if (segment == itemName) {
-            isRootSegment = false;
-            hItemSel = hItem;
-            segmentIdx++;
-
-            // If we still have segments to go down, we must check if children are loaded
-            if (segmentIdx < _pendingSelectPathSegments.size()) {
-                HTREEITEM hChild = _hTreeCtrl.GetChild(hItem);
-
-                // If it is a UNC server node, check if the child segment is present.
-                // If not, dynamically insert it!
-                if (FileSystemService::IsUncServerPath(GetPath(hItem))) {
-                    const std::wstring& childSegment = _pendingSelectPathSegments[segmentIdx];
-                    HTREEITEM hFoundChild = nullptr;
-                    HTREEITEM hChildIter = hChild;
-                    while (hChildIter != nullptr) {
-                        if (_hTreeCtrl.GetItemText(hChildIter) == childSegment) {
-                            hFoundChild = hChildIter;
-                            break;
-                        }
-                        hChildIter = _hTreeCtrl.GetNextItem(hChildIter, TVGN_NEXT);
-                    }
-
-                    if (hFoundChild == nullptr) {
-                        // Dynamically insert child segment (the share name)
-                        std::wstring sharePath = FileSystemService::CombinePath(GetPath(hItem), childSegment);
-                        auto shareEntry = std::make_shared<ExplorerEntry>(sharePath, FileSystemEntry(childSegment, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
-                        HTREEITEM hShareItem = InsertChildFolder(shareEntry, hItem, TVI_LAST, TRUE, FALSE, TRUE);
-
-                        // Add to parent ExplorerEntry's children
-                        auto* pParentShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
-                        if (pParentShared != nullptr && *pParentShared != nullptr) {
-                            auto parentEntry = *pParentShared;
-                            auto children = parentEntry->Children();
-                            children.push_back(shareEntry);
-                            parentEntry->SetChildren(children);
-                        }
-
-                        hChild = hShareItem;
-                    } else {
-                        hChild = hFoundChild;
-                    }
+        else {
+            auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
+            bool isLoaded = (pShared != nullptr && *pShared != nullptr && (*pShared)->HasLoadedChildren());
+            if (!isLoaded) {
+                // Not loaded yet! Request async fetch and stop.
+                _hTreeCtrl.SelectItem(hItem);
+                FetchChildren(hItem);
+                return;
+            }
+            // The name filter of the folder may hide it: show all children again
+            if (!GetTreeChildFilter(hItem).empty()) {
+                FilterTreeChildren(hItem, L"");
+                ResumePendingSelection();
+                return;
+            }
+            // The folder may be one of the children not paged in yet: page in
+            // up to it plus one page. Its index counts the shown folders only.
+            const std::wstring parentPath = GetPath(hItem);
+            const std::wstring childName = pathTable.Name(childPath);
+            const FileFilter& filter = _pSettings->GetFileFilter();
+            size_t childIndex = 0;
+            for (const auto& child : (*pShared)->Children()) {
+                if (!child->IsDirectory() || filter.isExcludedDirectory(parentPath, child->Name())) {
+                    continue;
                 }
-
-                if (hChild == nullptr) {
-                    auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
-                    bool isLoaded = (pShared != nullptr && *pShared != nullptr && (*pShared)->HasLoadedChildren());
-                    if (!isLoaded) {
-                        // Not loaded yet! Request async fetch and stop.
-                        _hTreeCtrl.SelectItem(hItem);
-                        FetchChildren(hItem);
+                if (::CompareStringOrdinal(child->Name().data(), static_cast<int>(child->Name().size()),
+                        childName.c_str(), static_cast<int>(childName.size()), TRUE) == CSTR_EQUAL) {
+                    if (childIndex >= GetTreeChildLimit(hItem)) {
+                        ShowMoreTreeChildren(hItem, childIndex + TreeModelSynchronizer::PAGE_SIZE);
+                        ResumePendingSelection();
                         return;
                     }
+                    break;
                 }
-                // Go to child
-                hItem = hChild;
+                childIndex++;
             }
-        } else {
-            /* search for next item in list */
-            hItem = _hTreeCtrl.GetNextItem(hItem, TVGN_NEXT);
         }
     }
 
-    // If we finished all segments successfully:
-    if (segmentIdx == _pendingSelectPathSegments.size() && hItemSel != nullptr) {
-        _hTreeCtrl.SelectItem(hItemSel);
-        _hTreeCtrl.EnsureVisible(hItemSel);
-        updateDockingDlg();
-    }
-
     // Failure / Success / Mismatch: clear pending state and restore notifications
-    _pendingSelectPathSegments.clear();
-    _pendingSelectRootItem = nullptr;
+    _pendingSelectPath = INVALID_PATH_ID;
     _isSelNotifyEnable = TRUE;
 }
 
@@ -1294,9 +1267,7 @@ void ExplorerDialog::ClearFilter()
     _ComboFilter.AddText(L"*.*");
     _ComboFilter.SetText(L"*.*");
     _FileList.filterFiles(L"*.*");
-    if (_pSettings->IsUseFullTree()) {
-        RefreshTreeFilter();
-    }
+    RefreshTreeFilter();
 }
 
 /**************************************************************************
@@ -1318,18 +1289,6 @@ void ExplorerDialog::OnDelete(bool immediate)
         if (hParentItem != nullptr) {
             _hTreeCtrl.SelectItem(hParentItem);
 
-            // Recursively remove from _checkedItems so we prevent leaking handles
-            auto RemoveFromCheckedItemsRecursive = [&](auto& self, HTREEITEM item) -> void {
-                if (item == nullptr) return;
-                _checkedItems.erase(item);
-                HTREEITEM child = _hTreeCtrl.GetChild(item);
-                while (child != nullptr) {
-                    self(self, child);
-                    child = _hTreeCtrl.GetNextItem(child, TVGN_NEXT);
-                }
-            };
-            RemoveFromCheckedItemsRecursive(RemoveFromCheckedItemsRecursive, hItem);
-
             _hTreeCtrl.DeleteItem(hItem);
             FetchChildren(hParentItem);
         } else {
@@ -1393,7 +1352,9 @@ void ExplorerDialog::OnPaste()
  */
 void ExplorerDialog::UpdateRoots()
 {
-    _checkedItems.clear();
+    // Entries probed before the rebuild are probed again
+    _probeGeneration++;
+    _queuedProbes.clear();
     auto root = _model->Root();
     if (!root) return;
 
@@ -1401,11 +1362,11 @@ void ExplorerDialog::UpdateRoots()
 
     auto drives = root->Children();
     for (const auto& driveEntry : drives) {
-        std::wstring volumeName = driveEntry->FSEntry().Name();
+        std::wstring volumeName(driveEntry->Name());
         std::wstring drivePath = driveEntry->Path();
-        bool haveChildren = FileSystemService::HaveChildren(drivePath, _pSettings->IsUseFullTree(), _pSettings->IsShowHidden());
+        bool haveChildren = FileSystemService::HaveChildren(drivePath, _pSettings->IsUseFullTree(), _pSettings->IsShowHidden(), _pSettings->GetFileFilter());
         HTREEITEM hItem = InsertChildFolder(driveEntry, TVI_ROOT, TVI_LAST, TRUE, FALSE, haveChildren);
-        if (hItem != nullptr && std::find(_expandedPaths.begin(), _expandedPaths.end(), drivePath) != _expandedPaths.end()) {
+        if (hItem != nullptr && std::find(_expandedPaths.begin(), _expandedPaths.end(), PathTable::Instance().Find(drivePath)) != _expandedPaths.end()) {
             _hTreeCtrl.Expand(hItem, TVE_EXPAND);
         }
     }
@@ -1424,7 +1385,7 @@ void ExplorerDialog::CollectExpandedPaths(HTREEITEM hItem)
     HTREEITEM hChild = (hItem == TVI_ROOT || hItem == nullptr) ? _hTreeCtrl.GetRoot() : _hTreeCtrl.GetChild(hItem);
     while (hChild != nullptr) {
         if (_hTreeCtrl.IsItemExpanded(hChild)) {
-            _expandedPaths.push_back(GetPath(hChild));
+            _expandedPaths.push_back(PathTable::Instance().Intern(GetPath(hChild)));
             CollectExpandedPaths(hChild);
         }
         hChild = _hTreeCtrl.GetNextItem(hChild, TVGN_NEXT);
@@ -1455,7 +1416,7 @@ HTREEITEM ExplorerDialog::InsertChildFolder(std::shared_ptr<ExplorerEntry> entry
 {
     DevType devType = (parentItem == TVI_ROOT ? DEVT_DRIVE : DEVT_DIRECTORY);
     std::wstring pathStr = entry->Path();
-    std::wstring childFolderName = entry->FSEntry().Name();
+    std::wstring childFolderName(entry->Name());
 
     /* insert item */
     INT iIconNormal     = ICON_FOLDER;
@@ -1464,38 +1425,21 @@ HTREEITEM ExplorerDialog::InsertChildFolder(std::shared_ptr<ExplorerEntry> entry
 
     /* get icons */
     if (_pSettings->IsUseSystemIcons()) {
-        GetIcons(pathStr, entry->FSEntry().Attributes(), &iIconNormal, &iIconSelected, &iIconOverlayed);
+        GetIcons(pathStr, entry->Attributes(), &iIconNormal, &iIconSelected, &iIconOverlayed);
     }
 
     auto* pSharedEntry = new std::shared_ptr<ExplorerEntry>(entry);
-    return _hTreeCtrl.InsertItem(childFolderName, iIconNormal, iIconSelected, iIconOverlayed, isHidden, parentItem, insertAfter, haveChildren, pSharedEntry);
-}
-
-BOOL ExplorerDialog::FindFolderAfter(LPCTSTR itemName, HTREEITEM pAfterItem)
-{
-    WCHAR       pszItem[MAX_PATH];
-    BOOL        isFound = FALSE;
-    HTREEITEM   hCurrentItem = _hTreeCtrl.GetNextItem(pAfterItem, TVGN_NEXT);
-
-    while (hCurrentItem != nullptr) {
-        _hTreeCtrl.GetItemText(hCurrentItem, pszItem, MAX_PATH);
-        if (_tcscmp(itemName, pszItem) == 0) {
-            isFound = TRUE;
-            hCurrentItem = nullptr;
-        }
-        else {
-            hCurrentItem = _hTreeCtrl.GetNextItem(hCurrentItem, TVGN_NEXT);
-        }
+    HTREEITEM hItem = _hTreeCtrl.InsertItem(childFolderName, iIconNormal, iIconSelected, iIconOverlayed, isHidden, parentItem, insertAfter, haveChildren, pSharedEntry);
+    if (hItem != nullptr) {
+        IndexTreeItem(hItem, PathTable::Instance().Intern(pathStr));
     }
-
-    return isFound;
+    return hItem;
 }
 
-
 void ExplorerDialog::FetchChildren(HTREEITEM parentItem)
 {
     auto parentFolderPath = GetPath(parentItem);
-    auto tempEntry = std::make_shared<ExplorerEntry>(parentFolderPath, FileSystemEntry(parentFolderPath, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
+    auto tempEntry = ExplorerEntry::Create(parentFolderPath, FileSystemEntry(parentFolderPath, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
     // Pass path as an explicit value-copy so the worker thread never dereferences
     // tempEntry->Path() across thread boundaries.
     _viewModel->UpdateDirectory(tempEntry, parentFolderPath);
@@ -1519,24 +1463,51 @@ std::wstring ExplorerDialog::GetPath(HTREEITEM currentItem) const
 
 HTREEITEM ExplorerDialog::FindTreeItemByPath(const std::wstring& path)
 {
-    auto FindTreeItemByPathRecursive = [&](const auto& self, HTREEITEM item) -> HTREEITEM {
-        while (item != nullptr) {
-            if (GetPath(item) == path) {
-                return item;
-            }
+    return FindTreeItemByPathId(PathTable::Instance().Find(path));
+}
 
-            HTREEITEM hChildItem = _hTreeCtrl.GetChild(item);
-            HTREEITEM hFoundItem = self(self, hChildItem);
-            if (hFoundItem != nullptr) {
-                return hFoundItem;
-            }
+HTREEITEM ExplorerDialog::FindTreeItemByPathId(PathId path) const
+{
+    auto found = _treeItemsByPath.find(path);
+    return (found != _treeItemsByPath.end()) ? found->second : nullptr;
+}
 
-            item = _hTreeCtrl.GetNextItem(item, TVGN_NEXT);
+void ExplorerDialog::IndexTreeItem(HTREEITEM hItem, PathId path)
+{
+    UnindexTreeItem(hItem);
+    _treeItemsByPath.emplace(path, hItem);
+    _pathsByTreeItem[hItem] = path;
+}
+
+void ExplorerDialog::UnindexTreeItem(HTREEITEM hItem)
+{
+    auto path = _pathsByTreeItem.find(hItem);
+    if (path == _pathsByTreeItem.end()) {
+        return;
+    }
+    auto [first, last] = _treeItemsByPath.equal_range(path->second);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == hItem) {
+            _treeItemsByPath.erase(it);
+            break;
         }
-        return nullptr;
-    };
+    }
+    _pathsByTreeItem.erase(path);
+}
 
-    return FindTreeItemByPathRecursive(FindTreeItemByPathRecursive, _hTreeCtrl.GetRoot());
+// A renamed folder moves its whole subtree to new paths
+void ExplorerDialog::ReindexTreeItems(HTREEITEM hItem, PathId oldPath, PathId newPath)
+{
+    auto path = _pathsByTreeItem.find(hItem);
+    if (path != _pathsByTreeItem.end()) {
+        PathId movedPath = PathTable::Instance().Rebase(path->second, oldPath, newPath);
+        if (movedPath != INVALID_PATH_ID) {
+            IndexTreeItem(hItem, movedPath);
+        }
+    }
+    for (HTREEITEM hChild = _hTreeCtrl.GetChild(hItem); hChild != nullptr; hChild = _hTreeCtrl.GetNextItem(hChild, TVGN_NEXT)) {
+        ReindexTreeItems(hChild, oldPath, newPath);
+    }
 }
 
 void ExplorerDialog::NotifyNewFile()
@@ -1936,28 +1907,18 @@ void ExplorerDialog::OnEntryUpdated(std::shared_ptr<ExplorerEntry> entry) {
             // Delegate the full insert/update/delete diff logic to the
             // dedicated synchronizer. ExplorerDialog retains responsibility
             // for the UI state that follows the structural sync.
-            TreeModelSynchronizer::Synchronize(*this, _hTreeCtrl, hItem, entry, _pSettings, *_viewModel);
+            SyncTreeChildren(hItem, entry);
 
-            // Schedule has-children checks for all visible direct children
-            HTREEITEM child = _hTreeCtrl.GetChild(hItem);
-            while (child != nullptr) {
+            auto isExpandedPath = [this](const std::wstring& path) {
+                return std::find(_expandedPaths.begin(), _expandedPaths.end(), PathTable::Instance().Find(path)) != _expandedPaths.end();
+            };
+
+            // Re-expand the direct children that were expanded before
+            for (HTREEITEM child = _hTreeCtrl.GetChild(hItem); child != nullptr; child = _hTreeCtrl.GetNextItem(child, TVGN_NEXT)) {
                 auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(child));
-                if (pShared != nullptr && *pShared != nullptr && (*pShared)->FSEntry().IsDirectory()) {
-                    std::wstring childPath = (*pShared)->Path();
-                    if (std::find(_expandedPaths.begin(), _expandedPaths.end(), childPath) != _expandedPaths.end()) {
-                        _hTreeCtrl.Expand(child, TVE_EXPAND);
-                    }
-                    else if (!_hTreeCtrl.IsItemExpanded(child) && _hTreeCtrl.GetChild(child) == nullptr) {
-                        RECT rect;
-                        if (_hTreeCtrl.GetItemRect(child, &rect, FALSE)) {
-                            if (_checkedItems.find(child) == _checkedItems.end()) {
-                                _checkedItems.insert(child);
-                                _viewModel->CheckFolderChildren(child, childPath);
-                            }
-                        }
-                    }
+                if (pShared != nullptr && *pShared != nullptr && (*pShared)->IsDirectory() && isExpandedPath((*pShared)->Path())) {
+                    _hTreeCtrl.Expand(child, TVE_EXPAND);
                 }
-                child = _hTreeCtrl.GetNextItem(child, TVGN_NEXT);
             }
 
             // Auto-expand a node that was pending expansion when FetchChildren was called
@@ -1966,19 +1927,64 @@ void ExplorerDialog::OnEntryUpdated(std::shared_ptr<ExplorerEntry> entry) {
                 _hItemExpand = nullptr;
             }
 
+            // May page in more children of this node
             ResumePendingSelection();
+
+            // The children in view are probed first, the remaining ones in the background.
+            // They are collected afterwards so that paged-in items are included.
             CheckVisibleFolderChildren();
+            std::vector<FolderProbe> probes;
+            for (HTREEITEM child = _hTreeCtrl.GetChild(hItem); child != nullptr; child = _hTreeCtrl.GetNextItem(child, TVGN_NEXT)) {
+                auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(child));
+                if (pShared == nullptr || *pShared == nullptr || !(*pShared)->IsDirectory()) {
+                    continue;
+                }
+                if (_hTreeCtrl.IsItemExpanded(child) || _hTreeCtrl.GetChild(child) != nullptr || isExpandedPath((*pShared)->Path())) {
+                    continue;
+                }
+                RECT rect;
+                if (_hTreeCtrl.GetItemRect(child, &rect, FALSE) && QueueProbe(child, **pShared, TaskPriority::Background)) {
+                    probes.push_back({ child, (*pShared)->Path(), (*pShared)->LastWriteTime(), _probeGeneration });
+                }
+            }
+            _viewModel->CheckFolderChildren(std::move(probes), TaskPriority::Background);
         }
     }
 }
 
-void ExplorerDialog::OnFolderChildrenChecked(HTREEITEM hItem, const std::wstring& path, bool hasChildren)
+bool ExplorerDialog::QueueProbe(HTREEITEM hItem, const ExplorerEntry& entry, TaskPriority priority)
+{
+    if (entry.IsProbeCurrent(_probeGeneration)) {
+        return false;
+    }
+    // An item already queued is only queued again to move it ahead, e.g. when
+    // it scrolls into view while its background batch is still waiting.
+    auto [queued, inserted] = _queuedProbes.try_emplace(hItem, priority);
+    if (!inserted) {
+        if (queued->second <= priority) {
+            return false;
+        }
+        queued->second = priority;
+    }
+    return true;
+}
+
+void ExplorerDialog::OnFolderChildrenChecked(const FolderProbe& probe, bool hasChildren)
 {
-    if (GetPath(hItem) == path) {
-        if (FileSystemService::IsUncServerPath(path)) {
-            _hTreeCtrl.SetItemHasChildren(hItem, TRUE);
+    // Answers of an earlier generation may no longer hold, e.g. after a filter change
+    if (probe.generation != _probeGeneration) {
+        return;
+    }
+    _queuedProbes.erase(probe.hItem);
+    if (GetPath(probe.hItem) == probe.path) {
+        auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(probe.hItem));
+        if (pShared != nullptr && *pShared != nullptr) {
+            (*pShared)->SetProbed(_probeGeneration);
+        }
+        if (FileSystemService::IsUncServerPath(probe.path)) {
+            _hTreeCtrl.SetItemHasChildren(probe.hItem, TRUE);
         } else {
-            _hTreeCtrl.SetItemHasChildren(hItem, hasChildren);
+            _hTreeCtrl.SetItemHasChildren(probe.hItem, hasChildren);
         }
     }
 }
@@ -2014,6 +2020,8 @@ void ExplorerDialog::handle(const EntryRenamedEvent& ev)
         auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
         if (pShared != nullptr && *pShared != nullptr) {
             (*pShared)->Rename(ev.newPath, ev.newName);
+            PathTable& pathTable = PathTable::Instance();
+            ReindexTreeItems(hItem, pathTable.Intern(ev.oldPath), pathTable.Intern(ev.newPath));
 
             // Elegantly set only the item text! Win32 TreeView preserves all other states!
             _hTreeCtrl.SetItemText(hItem, ev.newName);
@@ -2040,6 +2048,11 @@ void ExplorerDialog::RefreshTreeFilter()
         RefreshTreeFilter(hRoot);
         hRoot = _hTreeCtrl.GetNextItem(hRoot, TVGN_NEXT);
     }
+
+    // Folders may have gained or lost their only shown children
+    _probeGeneration++;
+    _queuedProbes.clear();
+    CheckVisibleFolderChildren();
 }
 
 void ExplorerDialog::RefreshTreeFilter(HTREEITEM hItem)
@@ -2050,7 +2063,7 @@ void ExplorerDialog::RefreshTreeFilter(HTREEITEM hItem)
 
     auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
     if (pShared != nullptr && *pShared != nullptr && (*pShared)->HasLoadedChildren()) {
-        TreeModelSynchronizer::Synchronize(*this, _hTreeCtrl, hItem, *pShared, _pSettings, *_viewModel);
+        SyncTreeChildren(hItem, *pShared, true);
     }
 
     HTREEITEM hChild = _hTreeCtrl.GetChild(hItem);
@@ -2065,6 +2078,9 @@ void ExplorerDialog::CheckVisibleFolderChildren()
 {
     HTREEITEM hItem = _hTreeCtrl.GetNextItem(nullptr, TVGN_FIRSTVISIBLE);
     bool seenVisible = false;
+    std::vector<HTREEITEM> visibleItems;
+    std::vector<FolderProbe> probes;
+    std::vector<HTREEITEM> pagedParents;
 
     while (hItem != nullptr) {
         RECT rect;
@@ -2075,14 +2091,20 @@ void ExplorerDialog::CheckVisibleFolderChildren()
         }
         else {
             seenVisible = true;
+            visibleItems.push_back(hItem);
 
             auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
-            if (pShared != nullptr && *pShared != nullptr && (*pShared)->FSEntry().IsDirectory()) {
+            if (pShared == nullptr) {
+                // Only the "more" item has no entry: scrolled into view, it pages in the next children
+                auto page = _treeChildPages.find(_hTreeCtrl.GetParent(hItem));
+                if (page != _treeChildPages.end() && page->second.hiddenCount != 0) {
+                    pagedParents.push_back(page->first);
+                }
+            }
+            else if (*pShared != nullptr && (*pShared)->IsDirectory()) {
                 if (!_hTreeCtrl.IsItemExpanded(hItem) && _hTreeCtrl.GetChild(hItem) == nullptr) {
-                    if (_checkedItems.find(hItem) == _checkedItems.end()) {
-                        _checkedItems.insert(hItem);
-                        std::wstring childPath = GetPath(hItem);
-                        _viewModel->CheckFolderChildren(hItem, childPath);
+                    if (QueueProbe(hItem, **pShared, TaskPriority::Visible)) {
+                        probes.push_back({ hItem, GetPath(hItem), (*pShared)->LastWriteTime(), _probeGeneration });
                     }
                 }
             }
@@ -2090,6 +2112,101 @@ void ExplorerDialog::CheckVisibleFolderChildren()
 
         hItem = _hTreeCtrl.GetNextItem(hItem, TVGN_NEXTVISIBLE);
     }
+
+    /* probe all folders in view with one task */
+    _viewModel->CheckFolderChildren(std::move(probes), TaskPriority::Visible);
+
+    /* icons queued for items scrolled out of view wait for the visible ones */
+    _viewModel->PrioritizeTreeItems(visibleItems);
+
+    /* items inserted above a "more" item being edited would leave the edit box behind */
+    if (_hTreeCtrl.GetEditControl() != nullptr) {
+        return;
+    }
+    for (HTREEITEM hParent : pagedParents) {
+        const size_t limit = GetTreeChildLimit(hParent);
+        ShowMoreTreeChildren(hParent, limit + TreeModelSynchronizer::PAGE_SIZE);
+    }
+}
+
+size_t ExplorerDialog::GetTreeChildLimit(HTREEITEM hItem) const
+{
+    auto page = _treeChildPages.find(hItem);
+    return (page != _treeChildPages.end()) ? page->second.limit : TreeModelSynchronizer::PAGE_SIZE;
+}
+
+std::wstring ExplorerDialog::GetTreeChildFilter(HTREEITEM hItem) const
+{
+    auto page = _treeChildPages.find(hItem);
+    return (page != _treeChildPages.end()) ? page->second.filter : std::wstring();
+}
+
+void ExplorerDialog::SyncTreeChildren(HTREEITEM hItem, const std::shared_ptr<ExplorerEntry>& entry, bool isRefilter)
+{
+    const size_t limit = GetTreeChildLimit(hItem);
+    const std::wstring filter = GetTreeChildFilter(hItem);
+    const size_t hiddenCount = isRefilter
+        ? TreeModelSynchronizer::Refilter(*this, _hTreeCtrl, hItem, entry, _pSettings, *_viewModel, limit, filter)
+        : TreeModelSynchronizer::Synchronize(*this, _hTreeCtrl, hItem, entry, _pSettings, *_viewModel, limit, filter);
+
+    /* a node that shows all its children at the default page size keeps no state */
+    if (hiddenCount == 0 && filter.empty() && limit == TreeModelSynchronizer::PAGE_SIZE) {
+        _treeChildPages.erase(hItem);
+    }
+    else {
+        _treeChildPages[hItem] = { limit, filter, hiddenCount };
+    }
+}
+
+void ExplorerDialog::ShowMoreTreeChildren(HTREEITEM hItem, size_t limit)
+{
+    auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
+    if (pShared == nullptr || *pShared == nullptr || !(*pShared)->HasLoadedChildren()) {
+        return;
+    }
+    _treeChildPages[hItem].limit = limit;
+    SyncTreeChildren(hItem, *pShared);
+}
+
+void ExplorerDialog::FilterTreeChildren(HTREEITEM hItem, const std::wstring& filter)
+{
+    auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(_hTreeCtrl.GetParam(hItem));
+    if (pShared == nullptr || *pShared == nullptr || !(*pShared)->HasLoadedChildren()) {
+        return;
+    }
+    /* a new filter starts over at the first page of its matches */
+    auto& page = _treeChildPages[hItem];
+    page.limit = TreeModelSynchronizer::PAGE_SIZE;
+    page.filter = filter;
+    SyncTreeChildren(hItem, *pShared);
+}
+
+/* opens the name filter of the paged node that is, or holds, the given item */
+void ExplorerDialog::EditTreeChildFilter(HTREEITEM hItem)
+{
+    if (hItem == nullptr) {
+        return;
+    }
+    HTREEITEM hNode = hItem;
+    if (!_treeChildPages.contains(hNode)) {
+        hNode = _hTreeCtrl.GetParent(hItem);
+        if (hNode == nullptr || !_treeChildPages.contains(hNode)) {
+            return;
+        }
+    }
+
+    /* the "more" item is the last child and the only one without an entry */
+    HTREEITEM hMoreItem = nullptr;
+    for (HTREEITEM hChild = _hTreeCtrl.GetChild(hNode); hChild != nullptr; hChild = _hTreeCtrl.GetNextItem(hChild, TVGN_NEXT)) {
+        hMoreItem = hChild;
+    }
+    if (hMoreItem == nullptr || _hTreeCtrl.GetParam(hMoreItem) != nullptr) {
+        return;
+    }
+    ::SetFocus(_hTreeCtrl);
+    _hTreeCtrl.SelectItem(hMoreItem);
+    _hTreeCtrl.EnsureVisible(hMoreItem);
+    _hTreeCtrl.EditLabel(hMoreItem);
 }
 
 void ExplorerDialog::OnCurrentDirectoryChanged(const std::wstring& path)
@@ -2186,6 +2303,10 @@ bool ExplorerDialog::TranslateShortcut(HWND hwnd, UINT message, WPARAM wParam, L
                 return true;
             }
         }
+        if (hwnd == _hTreeCtrl && wParam == 'F' && isCtrlPressed && !isShiftPressed && !isAltPressed) {
+            EditTreeChildFilter(_hTreeCtrl.GetSelection());
+            return true;
+        }
 
         // Custom TAB navigation
         if (wParam == VK_TAB && !isCtrlPressed && !isAltPressed) {
@@ -2315,7 +2436,7 @@ void ExplorerDialog::ShowSelectedProperties()
     auto entries = GetSelectedEntries();
     if (entries.empty()) {
         FileSystemEntry currentDirFsEntry(_pSettings->GetCurrentDir(), FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
-        entries.push_back(std::make_shared<ExplorerEntry>(_pSettings->GetCurrentDir(), currentDirFsEntry));
+        entries.push_back(ExplorerEntry::Create(_pSettings->GetCurrentDir(), currentDirFsEntry));
     }
 
     for (const auto& entry : entries) {
@@ -2351,7 +2472,7 @@ void ExplorerDialog::OpenQuickOpen()
     if (!entries.empty()) {
         auto entry = entries.front();
         path = entry->Path();
-        if (!entry->FSEntry().IsDirectory()) {
+        if (!entry->IsDirectory()) {
             std::filesystem::path fsPath(path);
             if (fsPath.has_parent_path()) {
                 path = fsPath.parent_path().wstring();
@@ -21,9 +21,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <string>
 #include <vector>
-#include <set>
 #include <filesystem>
 #include <optional>
+#include <unordered_map>
 
 #include "AddressBar.h"
 #include "ComboBox.h"
@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "TreeView.h"
 #include "ToolBar.h"
 #include "ExplorerModel.h"
+#include "PathTable.h"
 #include "../NppPlugin/DockingFeature/DockingDlgInterface.h"
 
 // Forward declaration only: avoids circular include with TreeModelSynchronizer.h
@@ -97,7 +98,6 @@ public:
     void RefreshTreeFilter(HTREEITEM hItem);
 
     // The following helpers are also used by TreeModelSynchronizer:
-    BOOL FindFolderAfter(LPCTSTR itemName, HTREEITEM pAfterItem);
     HTREEITEM InsertChildFolder(std::shared_ptr<ExplorerEntry> entry, HTREEITEM parentItem, HTREEITEM insertAfter = TVI_LAST, BOOL isDirectory = TRUE, BOOL isHidden = FALSE, BOOL haveChildren = TRUE);
     std::wstring GetPath(HTREEITEM currentItem) const;
 protected:
@@ -124,7 +124,7 @@ protected:
     void OnNavigationStateChanged() override;
     void OnCommandExecutionFailed(const std::wstring& command) override;
     void OnToggleWorkspaceModeRequested() override;
-    void OnFolderChildrenChecked(HTREEITEM hItem, const std::wstring& path, bool hasChildren) override;
+    void OnFolderChildrenChecked(const FolderProbe& probe, bool hasChildren) override;
 
     // Event handle overrides
     std::optional<std::wstring> handle(const PromptForNameEvent& ev) override;
@@ -150,14 +150,35 @@ protected:
     void HandleToolBarDropDown(LPNMTOOLBAR lpnmtb);
 
     HTREEITEM FindTreeItemByPath(const std::wstring& path);
+    HTREEITEM FindTreeItemByPathId(PathId path) const;
+    void IndexTreeItem(HTREEITEM hItem, PathId path);
+    void UnindexTreeItem(HTREEITEM hItem);
+    void ReindexTreeItems(HTREEITEM hItem, PathId oldPath, PathId newPath);
+    size_t GetTreeChildLimit(HTREEITEM hItem) const;
+    std::wstring GetTreeChildFilter(HTREEITEM hItem) const;
+    void SyncTreeChildren(HTREEITEM hItem, const std::shared_ptr<ExplorerEntry>& entry, bool isRefilter = false);
+    void ShowMoreTreeChildren(HTREEITEM hItem, size_t limit);
+    void FilterTreeChildren(HTREEITEM hItem, const std::wstring& filter);
+    void EditTreeChildFilter(HTREEITEM hItem);
     void FetchChildren(HTREEITEM parentItem);
     void UpdateLayout();
     void ResumePendingSelection();
 private:
     std::shared_ptr<ExplorerModel> _model;
     std::shared_ptr<ExplorerViewModel> _viewModel;
-    std::vector<std::wstring> _pendingSelectPathSegments;
-    HTREEITEM _pendingSelectRootItem;
+    PathId _pendingSelectPath{INVALID_PATH_ID};
+
+    /* tree items by the interned path of their entry, kept in step on insert, delete and rename */
+    std::unordered_multimap<PathId, HTREEITEM> _treeItemsByPath;
+    std::unordered_map<HTREEITEM, PathId> _pathsByTreeItem;
+
+    /* nodes whose children are paged or filtered by name, and how many of them are left out */
+    struct TreeChildPage {
+        size_t          limit{0};
+        std::wstring    filter;
+        size_t          hiddenCount{0};
+    };
+    std::unordered_map<HTREEITEM, TreeChildPage> _treeChildPages;
     /* Handles */
     BOOL        _bStartupFinish;
     HTREEITEM   _hItemExpand;
@@ -168,6 +189,7 @@ private:
 
     /* some status values */
     BOOL        _isSelNotifyEnable;
+    std::wstring _warnedFilter;     /* last filter whose ignored folder rules were reported */
 
     /* handles of controls */
     HWND        _hListCtrl;
@@ -198,10 +220,14 @@ private:
 
     INT         _iDockedPos;
 
-    std::set<HTREEITEM> _checkedItems;
+    /* stamped on entries whose has-children state was probed; bumped when the roots are rebuilt */
+    unsigned int _probeGeneration{1};
+    /* items with a probe on its way, and the priority it was queued at */
+    std::unordered_map<HTREEITEM, TaskPriority> _queuedProbes;
+    bool QueueProbe(HTREEITEM hItem, const ExplorerEntry& entry, TaskPriority priority);
     std::wstring _pendingNavigateDir;
 
-    std::vector<std::wstring> _expandedPaths;
+    std::vector<PathId> _expandedPaths;
     void CollectExpandedPaths(HTREEITEM hItem);
     void CheckVisibleFolderChildren();
 };
@@ -1,46 +1,177 @@
 #include "ExplorerModel.h"
 #include "FileSystemService.h"
 #include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <unordered_map>
 
-ExplorerEntry::ExplorerEntry(const std::wstring& path, const FileSystemEntry& fsEntry)
-    : _path(path)
-    , _fsEntry(fsEntry)
-    , _hasLoadedChildren(false)
+class ExplorerEntry::Arena {
+public:
+    Arena(std::wstring basePath, size_t entryCount, size_t nameChars)
+        : _basePath(std::move(basePath))
+        , _names(std::make_unique<wchar_t[]>(nameChars))
+    {
+        _entries.reserve(entryCount);
+    }
+
+    const std::wstring& BasePath() const { return _basePath; }
+    void SetBasePath(const std::wstring& basePath) { _basePath = basePath; }
+
+    ExplorerEntry& Add(const std::wstring& name, const wchar_t* path, const FileSystemEntry& fsEntry)
+    {
+        // Both buffers are sized up front, so entries and names never move.
+        wchar_t* stored = _names.get() + _namesUsed;
+        std::copy(name.begin(), name.end(), stored);
+        stored[name.size()] = L'\0';
+        _namesUsed += name.size() + 1;
+        return _entries.emplace_back(*this, stored, name.size(), path, fsEntry);
+    }
+
+    // Explicit paths that are known when the arena is built.
+    const wchar_t* Keep(std::wstring text)
+    {
+        return _strings.emplace_back(std::move(text)).c_str();
+    }
+
+    // Strings an entry got by a rename. Only the latest name and path of each
+    // entry are kept, so renaming the same entry again frees the previous
+    // ones; a re-read listing builds a new arena without any of them.
+    const wchar_t* KeepRenamedName(const ExplorerEntry* entry, const std::wstring& name)
+    {
+        std::wstring& stored = _renamed[entry].name;
+        stored = name;
+        return stored.c_str();
+    }
+
+    const wchar_t* KeepRenamedPath(const ExplorerEntry* entry, const std::wstring& path)
+    {
+        std::wstring& stored = _renamed[entry].path;
+        stored = path;
+        return stored.c_str();
+    }
+
+    // Sort keys are set after the listing, so they are packed into blocks
+    // instead of allocating one string per entry.
+    const char* KeepBytes(std::string_view bytes)
+    {
+        constexpr size_t BLOCK_SIZE = 16 * 1024;
+        if (_bytesBlocks.empty() || _bytesUsed + bytes.size() > _bytesBlockSize) {
+            _bytesBlockSize = std::max(BLOCK_SIZE, bytes.size());
+            _bytesBlocks.push_back(std::make_unique<char[]>(_bytesBlockSize));
+            _bytesUsed = 0;
+        }
+        char* stored = _bytesBlocks.back().get() + _bytesUsed;
+        std::copy(bytes.begin(), bytes.end(), stored);
+        _bytesUsed += bytes.size();
+        return stored;
+    }
+
+private:
+    std::wstring _basePath;
+    std::vector<ExplorerEntry> _entries;
+    std::unique_ptr<wchar_t[]> _names;
+    size_t _namesUsed{0};
+    std::deque<std::wstring> _strings;
+    struct RenamedStrings {
+        std::wstring name;
+        std::wstring path;
+    };
+    std::unordered_map<const ExplorerEntry*, RenamedStrings> _renamed;
+    std::vector<std::unique_ptr<char[]>> _bytesBlocks;
+    size_t _bytesBlockSize{0};
+    size_t _bytesUsed{0};
+};
+
+std::shared_ptr<ExplorerEntry> ExplorerEntry::Create(const std::wstring& path, const FileSystemEntry& fsEntry)
 {
+    auto arena = std::make_shared<Arena>(std::wstring(), 1, fsEntry.Name().size() + 1);
+    ExplorerEntry& entry = arena->Add(fsEntry.Name(), arena->Keep(path), fsEntry);
+    return std::shared_ptr<ExplorerEntry>(arena, &entry);
 }
 
-std::wstring ExplorerEntry::Path() const {
-    if (!_path.empty()) {
-        return _path;
+std::vector<std::shared_ptr<ExplorerEntry>> ExplorerEntry::CreateChildren(const std::wstring& parentPath, const std::vector<FileSystemEntry>& fsEntries)
+{
+    std::wstring basePath = parentPath;
+    if (!basePath.empty() && basePath.back() != L'\\') {
+        basePath += L'\\';
     }
-    if (auto p = _parent.lock()) {
-        return FileSystemService::CombinePath(p->Path(), _fsEntry.Name());
+
+    size_t nameChars = 0;
+    for (const auto& fsEntry : fsEntries) {
+        nameChars += fsEntry.Name().size() + 1;
     }
-    return _path;
+
+    auto arena = std::make_shared<Arena>(std::move(basePath), fsEntries.size(), nameChars);
+    std::vector<std::shared_ptr<ExplorerEntry>> children;
+    children.reserve(fsEntries.size());
+    for (const auto& fsEntry : fsEntries) {
+        const wchar_t* path = nullptr;
+        if (fsEntry.IsParent()) {
+            std::filesystem::path current(parentPath);
+            path = arena->Keep((current.has_parent_path() && current.parent_path() != current.root_path())
+                ? current.parent_path().wstring()
+                : current.root_path().wstring());
+        }
+        children.emplace_back(arena, &arena->Add(fsEntry.Name(), path, fsEntry));
+    }
+    return children;
 }
 
-const FileSystemEntry& ExplorerEntry::FSEntry() const {
-    return _fsEntry;
+ExplorerEntry::ExplorerEntry(Arena& arena, const wchar_t* name, size_t nameLength, const wchar_t* path, const FileSystemEntry& fsEntry)
+    : _arena(&arena)
+    , _name(name)
+    , _path(path)
+    , _fileSize(fsEntry.FileSize())
+    , _lastWriteTime(fsEntry.LastWriteTime())
+    , _nameLength(static_cast<unsigned int>(nameLength))
+    , _attributes(fsEntry.Attributes())
+    , _flags(static_cast<unsigned char>((fsEntry.IsDirectory() ? FLAG_DIRECTORY : 0) | (fsEntry.IsHidden() ? FLAG_HIDDEN : 0) | (fsEntry.IsParent() ? FLAG_PARENT : 0)))
+    , _hasLoadedChildren(false)
+{
+}
+
+std::wstring ExplorerEntry::Path() const {
+    if (_path != nullptr) {
+        return _path;
+    }
+    const std::wstring& basePath = _arena->BasePath();
+    std::wstring path;
+    path.reserve(basePath.size() + _nameLength);
+    path.append(basePath).append(Name());
+    return path;
 }
 
 void ExplorerEntry::Rename(const std::wstring& newPath, const std::wstring& newName) {
-    _path = newPath;
-    _fsEntry.SetName(newName);
+    if (Name() != newName) {
+        _name = _arena->KeepRenamedName(this, newName);
+        _nameLength = static_cast<unsigned int>(newName.size());
+        _sortKey = nullptr;
+        _sortKeyLength = 0;
+    }
+    if (_path != nullptr && newPath != _path) {
+        _path = _arena->KeepRenamedPath(this, newPath);
+    }
 
-    std::wstring basePath = _path;
+    std::wstring basePath = newPath;
     if (!basePath.empty() && basePath.back() != L'\\') {
         basePath += L'\\';
     }
     for (auto& child : _children) {
-        child->Rename(basePath + child->FSEntry().Name(), child->FSEntry().Name());
+        if (child->_path == nullptr && child->_arena->BasePath() != basePath) {
+            child->_arena->SetBasePath(basePath);
+        }
+        std::wstring childName(child->Name());
+        child->Rename(basePath + childName, childName);
     }
 }
 
+void ExplorerEntry::SetSortKey(std::string_view key) const {
+    _sortKey = _arena->KeepBytes(key);
+    _sortKeyLength = static_cast<unsigned int>(key.size());
+}
+
 void ExplorerEntry::SetChildren(std::vector<std::shared_ptr<ExplorerEntry>> children) {
     _children = std::move(children);
-    for (auto& child : _children) {
-        child->_parent = const_cast<ExplorerEntry*>(this)->shared_from_this();
-    }
     _hasLoadedChildren = true;
 }
 
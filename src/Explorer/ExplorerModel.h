@@ -1,18 +1,28 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <mutex>
 #include <functional>
 #include "FileSystemService.h"
 
-class ExplorerEntry : public std::enable_shared_from_this<ExplorerEntry> {
+class ExplorerEntry {
+    class Arena;
+
 public:
-    ExplorerEntry(const std::wstring& path, const FileSystemEntry& fsEntry);
+    // Entries are allocated in arenas: all entries of one directory listing and
+    // their names share two allocations, and the returned pointers keep the
+    // whole arena alive. Views must therefore re-point their items to the
+    // entries of a re-read listing, as the tree synchronizer and the file list
+    // do, instead of holding on to single entries of the old one.
+    static std::shared_ptr<ExplorerEntry> Create(const std::wstring& path, const FileSystemEntry& fsEntry);
+    static std::vector<std::shared_ptr<ExplorerEntry>> CreateChildren(const std::wstring& parentPath, const std::vector<FileSystemEntry>& fsEntries);
+
+    ExplorerEntry(Arena& arena, const wchar_t* name, size_t nameLength, const wchar_t* path, const FileSystemEntry& fsEntry);
 
     std::wstring Path() const;
-    const FileSystemEntry& FSEntry() const;
     void Rename(const std::wstring& newPath, const std::wstring& newName);
 
     void SetChildren(std::vector<std::shared_ptr<ExplorerEntry>> children);
@@ -27,26 +37,55 @@ public:
     void SetOverlay(int overlay) const { _overlay = overlay; }
     unsigned int ViewState() const { return _viewState; }
     void SetViewState(unsigned int state) const { _viewState = state; }
-    void ResetViewCache() const { _icon = -1; _overlay = 0; _viewState = 0; }
+    // Set once the icon task delivered the shell icon; until then Icon() may hold a placeholder.
+    bool IsIconFetched() const { return _isIconFetched; }
+    void SetIconFetched(bool fetched) const { _isIconFetched = fetched; }
+    void ResetViewCache() const { _icon = -1; _overlay = 0; _viewState = 0; _isIconFetched = false; }
+    void CopyViewCache(const ExplorerEntry& other) const { _icon = other._icon; _overlay = other._overlay; _viewState = other._viewState; _isIconFetched = other._isIconFetched; }
+    // Binary collation key of the name, compared bytewise; empty until the view that sorts by it sets it.
+    std::string_view SortKey() const { return { _sortKey, _sortKeyLength }; }
+    void SetSortKey(std::string_view key) const;
+    // Has-children probe bookkeeping of the tree: the probe generation of the
+    // last check and the write time of the folder it saw. Generation 0 means
+    // never probed; a refreshed entry takes the state of the one it replaces.
+    bool IsProbeCurrent(unsigned int generation) const { return _probeGeneration == generation && _probedWriteTime == _lastWriteTime; }
+    void SetProbed(unsigned int generation) const { _probeGeneration = generation; _probedWriteTime = _lastWriteTime; }
+    void CopyProbeState(const ExplorerEntry& other) const { _probeGeneration = other._probeGeneration; _probedWriteTime = other._probedWriteTime; }
 
-    // Convenience accessors (delegate to FSEntry)
-    const std::wstring& Name() const { return _fsEntry.Name(); }
-    bool IsDirectory() const { return _fsEntry.IsDirectory(); }
-    bool IsHidden() const { return _fsEntry.IsHidden(); }
-    bool IsParent() const { return _fsEntry.IsParent(); }
-    unsigned int Attributes() const { return _fsEntry.Attributes(); }
-    size_t FileSize() const { return _fsEntry.FileSize(); }
-    time_t LastWriteTime() const { return _fsEntry.LastWriteTime(); }
+    // The name is always null-terminated, so Name().data() can be handed to Win32 APIs.
+    std::wstring_view Name() const { return { _name, _nameLength }; }
+    bool IsDirectory() const { return (_flags & FLAG_DIRECTORY) != 0; }
+    bool IsHidden() const { return (_flags & FLAG_HIDDEN) != 0; }
+    bool IsParent() const { return (_flags & FLAG_PARENT) != 0; }
+    unsigned int Attributes() const { return _attributes; }
+    size_t FileSize() const { return _fileSize; }
+    time_t LastWriteTime() const { return _lastWriteTime; }
 
 private:
-    std::weak_ptr<ExplorerEntry> _parent;
-    std::wstring _path;
-    FileSystemEntry _fsEntry;
+    enum : unsigned char {
+        FLAG_DIRECTORY  = 0x01,
+        FLAG_HIDDEN     = 0x02,
+        FLAG_PARENT     = 0x04,
+    };
+
+    Arena* _arena;
+    const wchar_t* _name;
+    const wchar_t* _path;       // nullptr: derived from the arena's base path and the name
+    mutable const char* _sortKey{nullptr};
     std::vector<std::shared_ptr<ExplorerEntry>> _children;
-    bool _hasLoadedChildren;
+    size_t _fileSize;
+    time_t _lastWriteTime;
+    mutable time_t _probedWriteTime{0};
+    unsigned int _nameLength;
+    mutable unsigned int _sortKeyLength{0};
+    unsigned int _attributes;
     mutable int _icon{-1};
     mutable int _overlay{0};
     mutable unsigned int _viewState{0};
+    mutable unsigned int _probeGeneration{0};
+    unsigned char _flags;
+    bool _hasLoadedChildren;
+    mutable bool _isIconFetched{false};
 };
 
 class IExplorerModelObserver {
@@ -2,140 +2,244 @@
 #include "FileList.h"
 #include "ExplorerDialog.h"
 #include "ExplorerViewModel.h"
+#include "TreeView.h"
+#include <algorithm>
 
-TaskInit::TaskInit(std::shared_ptr<ExplorerModel> model, Settings* settings)
-    : _model(model), _settings(settings) {}
-
-void TaskInit::Execute() {
-    std::vector<std::shared_ptr<ExplorerEntry>> children;
+namespace {
+// The first chunk of a streamed listing fills about a screen; later ones grow
+// so that a huge folder needs few round trips.
+constexpr size_t STREAM_FIRST_CHUNK_SIZE = 256;
+constexpr size_t STREAM_MAX_CHUNK_SIZE = 8192;
 
-    const auto& workspaceFolders = _settings->GetWorkspaceFolders();
-    if (!_settings->IsShowWorkspaceMode()) {
-        auto drives = FileSystemService::GetLogicalDrives();
-        for (const auto& drivePath : drives) {
-            auto volumeName = FileSystemService::GetVolumeName(drivePath);
-            std::wstring name = volumeName ? std::format(L"{}: [{}]", drivePath[0], *volumeName) : std::format(L"{}:", drivePath[0]);
+TaskViewKey TreeItemKey(HTREEITEM hItem)
+{
+    return { reinterpret_cast<intptr_t>(hItem), reinterpret_cast<intptr_t>(hItem) };
+}
 
-            FileSystemEntry fsEntry(name, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
-            children.push_back(std::make_shared<ExplorerEntry>(drivePath, fsEntry));
-        }
+void PublishChildren(const std::shared_ptr<ExplorerModel>& model, const std::shared_ptr<ExplorerEntry>& entry, std::vector<std::shared_ptr<ExplorerEntry>> children, ExplorerViewModel* viewModel)
+{
+    entry->SetChildren(children);
+    if (viewModel) {
+        viewModel->OnEntryUpdated(entry);
     } else {
-        for (const auto& folderPath : workspaceFolders) {
-            if (folderPath.empty()) continue;
-            
-            std::wstring name = folderPath;
-            if (name.size() > 3 && name.back() == L'\\') {
-                name.pop_back();
-            }
-            size_t slash = name.find_last_of(L'\\');
-            std::wstring displayName = (slash != std::wstring::npos) ? name.substr(slash + 1) : name;
-            if (displayName.empty()) {
-                displayName = folderPath;
-            }
-
-            FileSystemEntry fsEntry(displayName, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
-            children.push_back(std::make_shared<ExplorerEntry>(folderPath, fsEntry));
-        }
+        model->NotifyEntryUpdated(entry);
     }
-
-    _root = std::make_shared<ExplorerEntry>(L"This PC", FileSystemEntry(L"This PC", FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
-    _root->SetChildren(children);
 }
+} // namespace
 
-void TaskInit::OnCompleted() {
-    _model->SetRoot(_root);
-    _model->NotifyEntryUpdated(_root);
-}
+AsyncTask InitModelAsync(WorkerThread& worker, std::shared_ptr<ExplorerModel> model, Settings* settings)
+{
+    // Settings are only touched on the UI thread; hand copies to the worker.
+    const bool showWorkspaceMode = settings->IsShowWorkspaceMode();
+    const std::vector<std::wstring> workspaceFolders = settings->GetWorkspaceFolders();
 
-TaskUpdateDirectory::TaskUpdateDirectory(std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, const std::wstring& path, Settings* settings, bool includeParent, ExplorerViewModel* viewModel)
-    : _model(model), _entry(entry), _path(path), _settings(settings), _includeParent(includeParent), _viewModel(viewModel) {}
+    auto root = co_await RunOnWorker(worker, { .priority = TaskPriority::Visible, .category = TaskCategory::TreeView }, [showWorkspaceMode, workspaceFolders] {
+        std::vector<std::shared_ptr<ExplorerEntry>> children;
 
-void TaskUpdateDirectory::Execute() {
-    // Use _path (value-copied in constructor, immutable on this thread) -- do NOT call
-    // _entry->Path() here, as _entry may be modified concurrently from the UI thread.
-    auto entries = FileSystemService::GetDirectoryEntries(_path, _settings->IsShowHidden(), _includeParent);
+        if (!showWorkspaceMode) {
+            auto drives = FileSystemService::GetLogicalDrives();
+            for (const auto& drivePath : drives) {
+                auto volumeName = FileSystemService::GetVolumeName(drivePath);
+                std::wstring name = volumeName ? std::format(L"{}: [{}]", drivePath[0], *volumeName) : std::format(L"{}:", drivePath[0]);
 
-    std::wstring basePath = _path;
-    if (!basePath.empty() && basePath.back() != L'\\') {
-        basePath += L'\\';
-    }
-
-    for (const auto& fsEntry : entries) {
-        std::wstring childPath;
-        if (fsEntry.IsParent()) {
-            std::filesystem::path current(_path);
-            childPath = (current.has_parent_path() && current.parent_path() != current.root_path())
-                ? current.parent_path().wstring()
-                : current.root_path().wstring();
+                FileSystemEntry fsEntry(name, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
+                children.push_back(ExplorerEntry::Create(drivePath, fsEntry));
+            }
         } else {
-            childPath = basePath + fsEntry.Name();
+            for (const auto& folderPath : workspaceFolders) {
+                if (folderPath.empty()) continue;
+
+                std::wstring name = folderPath;
+                if (name.size() > 3 && name.back() == L'\\') {
+                    name.pop_back();
+                }
+                size_t slash = name.find_last_of(L'\\');
+                std::wstring displayName = (slash != std::wstring::npos) ? name.substr(slash + 1) : name;
+                if (displayName.empty()) {
+                    displayName = folderPath;
+                }
+
+                FileSystemEntry fsEntry(displayName, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
+                children.push_back(ExplorerEntry::Create(folderPath, fsEntry));
+            }
         }
-        _children.push_back(std::make_shared<ExplorerEntry>(childPath, fsEntry));
-    }
-}
 
-void TaskUpdateDirectory::OnCompleted() {
-    _entry->SetChildren(_children);
-    if (_viewModel) {
-        _viewModel->OnEntryUpdated(_entry);
-    } else {
-        _model->NotifyEntryUpdated(_entry);
-    }
+        auto root = ExplorerEntry::Create(L"This PC", FileSystemEntry(L"This PC", FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
+        root->SetChildren(children);
+        return root;
+    });
+
+    model->SetRoot(root);
+    model->NotifyEntryUpdated(root);
 }
 
-TaskCheckFolderChildren::TaskCheckFolderChildren(ExplorerViewModel* viewModel, HTREEITEM hItem, const std::wstring& path, Settings* settings)
-    : _viewModel(viewModel), _hItem(hItem), _path(path), _settings(settings) {}
+AsyncTask UpdateDirectoryAsync(WorkerThread& worker, IDispatcher* dispatcher, DirectoryCache* cache, std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, std::wstring path, Settings* settings, bool includeParent, ExplorerViewModel* viewModel)
+{
+    const bool showHidden = settings->IsShowHidden();
 
-void TaskCheckFolderChildren::Execute() {
-    _hasChildren = FileSystemService::HaveChildren(_path, _settings->IsUseFullTree(), _settings->IsShowHidden());
-}
+    std::optional<std::vector<FileSystemEntry>> cached;
+    if (const auto listing = cache->Find(path)) {
+        cached = DirectoryCache::Select(*listing, showHidden, includeParent);
+        if (dispatcher) {
+            co_await ResumeOnDispatcher(*dispatcher);
+        }
+        PublishChildren(model, entry, ExplorerEntry::CreateChildren(path, *cached), viewModel);
+    }
 
-void TaskCheckFolderChildren::OnCompleted() {
-    _viewModel->OnFolderChildrenChecked(_hItem, _path, _hasChildren);
+    // Revalidation of a listing the user already sees is not urgent.
+    const WorkerOptions options = {
+        .priority = cached ? TaskPriority::Background : TaskPriority::Visible,
+        .category = TaskCategory::TreeView,
+    };
+
+    // Use path (value-copied, immutable on the worker) -- do NOT call entry->Path()
+    // there, as entry may be modified concurrently from the UI thread.
+    auto entries = co_await RunOnWorker(worker, options, [cache, path, showHidden, includeParent, epoch = cache->Epoch()] {
+        auto listing = DirectoryCache::ReadListing(path);
+        auto entries = DirectoryCache::Select(listing, showHidden, includeParent);
+        cache->Store(path, std::move(listing), epoch);
+        return entries;
+    });
+
+    if (cached && *cached == entries) {
+        co_return;
+    }
+    PublishChildren(model, entry, ExplorerEntry::CreateChildren(path, entries), viewModel);
 }
 
-TaskFetchIcons::TaskFetchIcons(FileList* fileList, HWND hListWnd, const std::wstring& workDir, std::vector<IconWorkItem>&& workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation)
-    : _fileList(fileList), _hListWnd(hListWnd), _workDir(workDir), _vWorkItems(std::move(workItems)), _cancelToken(cancelToken), _generation(generation) {}
+AsyncTask StreamDirectoryAsync(WorkerThread& worker, DirectoryCache* cache, std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, std::wstring path, Settings* settings, bool includeParent, ExplorerViewModel* viewModel)
+{
+    const bool showHidden = settings->IsShowHidden();
+    const uint64_t epoch = cache->Epoch();
+
+    // Owned by the frame: when navigation drops the pending FileList steps,
+    // the frame goes with them and closes the find handle.
+    DirectoryEnumerator enumerator(path, true, true);
+    std::vector<FileSystemEntry> listing;
+    std::vector<std::shared_ptr<ExplorerEntry>> children;
 
-void TaskFetchIcons::Execute() {
-    for (const auto& item : _vWorkItems) {
-        if (_cancelToken && _cancelToken->load()) {
-            break;
+    size_t chunkSize = STREAM_FIRST_CHUNK_SIZE;
+    bool hasMore = true;
+    while (hasMore) {
+        auto chunk = co_await RunOnWorker(worker, { .priority = TaskPriority::Visible, .category = TaskCategory::FileList }, [&enumerator, &listing, chunkSize, showHidden, includeParent] {
+            const size_t begin = listing.size();
+            const bool more = enumerator.Read(listing, chunkSize);
+            return std::make_pair(DirectoryCache::Select(std::span(listing).subspan(begin), showHidden, includeParent), more);
+        });
+        hasMore = chunk.second;
+
+        if (viewModel->GetCurrentDirEntry() != entry) {
+            co_return;
         }
+        auto appended = ExplorerEntry::CreateChildren(path, chunk.first);
+        children.insert(children.end(), appended.begin(), appended.end());
+        viewModel->OnEntryChildrenAppended(entry, appended);
 
-        int icon = 0;
-        int iconSelected = 0;
-        int overlay = 0;
+        chunkSize = std::min(chunkSize * 2, STREAM_MAX_CHUNK_SIZE);
+    }
 
-        FetchIcons(_workDir.c_str(), item.name.c_str(), item.type, &icon, &iconSelected, &overlay);
+    cache->Store(path, std::move(listing), epoch);
+    PublishChildren(model, entry, std::move(children), viewModel);
+}
 
-        if (_cancelToken && _cancelToken->load()) {
-            break;
+AsyncTask CheckFolderChildrenAsync(WorkerThread& worker, DirectoryCache* cache, ExplorerViewModel* viewModel, std::vector<FolderProbe> probes, Settings* settings, TaskPriority priority)
+{
+    const bool useFullTree = settings->IsUseFullTree();
+    const bool showHidden = settings->IsShowHidden();
+    const FileFilter& filter = settings->GetFileFilter();
+    // Read before any rule is applied, so an answer is never stamped newer than its rules
+    const uint64_t filterGeneration = filter.getGeneration();
+
+    std::vector<FolderProbe> pending;
+    for (auto& probe : probes) {
+        std::optional<bool> hasChildren = cache->FindHasChildren(probe.path, probe.lastWriteTime, useFullTree, showHidden, filterGeneration);
+        if (!hasChildren.has_value()) {
+            if (const auto listing = cache->Peek(probe.path)) {
+                hasChildren = DirectoryCache::HasChildren(probe.path, *listing, useFullTree, showHidden, filter);
+            }
         }
+        if (hasChildren.has_value()) {
+            viewModel->OnFolderChildrenChecked(probe, *hasChildren);
+        } else {
+            pending.push_back(std::move(probe));
+        }
+    }
+    if (pending.empty()) {
+        co_return;
+    }
 
-        IconResult* result = new IconResult{ _workDir, item.index, icon, overlay, _generation, item.name };
-        if (!::PostMessage(_hListWnd, EXM_UPDATE_ICON_RESULT, 0, (LPARAM)result)) {
-            delete result;
+    const auto results = co_await RunOnWorker(worker, { .priority = priority, .category = TaskCategory::TreeView }, [&pending, &filter, cache, useFullTree, showHidden, filterGeneration] {
+        std::vector<bool> results;
+        results.reserve(pending.size());
+        for (const auto& probe : pending) {
+            // A folder queued again at a higher priority may have been answered meanwhile
+            std::optional<bool> hasChildren = cache->FindHasChildren(probe.path, probe.lastWriteTime, useFullTree, showHidden, filterGeneration);
+            if (!hasChildren.has_value()) {
+                hasChildren = FileSystemService::HaveChildren(probe.path, useFullTree, showHidden, filter);
+                cache->StoreHasChildren(probe.path, probe.lastWriteTime, useFullTree, showHidden, filterGeneration, *hasChildren);
+            }
+            results.push_back(*hasChildren);
         }
+        return results;
+    });
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        viewModel->OnFolderChildrenChecked(pending[i], results[i]);
     }
 }
 
-void TaskFetchIcons::OnCompleted() {
-    // Incrementally posted results to FileList, nothing to do on complete.
-}
+AsyncTask FetchFileListIconsAsync(WorkerThread& worker, HWND hListWnd, std::wstring workDir, std::vector<IconWorkItem> workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation)
+{
+    if (workItems.empty()) {
+        co_return;
+    }
 
-#include "TreeView.h"
+    // The list hands in the viewport rows first, so the range is not at the ends.
+    const auto rowRange = std::minmax_element(workItems.begin(), workItems.end(), [](const IconWorkItem& lhs, const IconWorkItem& rhs) {
+        return lhs.index < rhs.index;
+    });
+    const TaskViewKey rows{ static_cast<intptr_t>(rowRange.first->index), static_cast<intptr_t>(rowRange.second->index) };
+
+    // Results are posted to the list one by one as they arrive, nothing is left for the UI thread.
+    co_await RunOnWorker(worker, { .category = TaskCategory::FileListIcons, .viewKey = rows }, [&] {
+        for (const auto& item : workItems) {
+            if (cancelToken && cancelToken->load()) {
+                break;
+            }
+
+            int icon = 0;
+            int iconSelected = 0;
+            int overlay = 0;
 
-TaskTreeViewFetchIcons::TaskTreeViewFetchIcons(TreeView* treeCtrl, HTREEITEM hItem, const std::wstring& path, DevType devType)
-    : _treeCtrl(treeCtrl), _hItem(hItem), _path(path), _devType(devType) {}
+            FetchIcons(workDir.c_str(), item.name.c_str(), item.type, &icon, &iconSelected, &overlay);
 
-void TaskTreeViewFetchIcons::Execute() {
-    FetchIcons(_path.c_str(), nullptr, _devType, &_icon, &_iconSelected, &_overlay);
+            if (cancelToken && cancelToken->load()) {
+                break;
+            }
+
+            IconResult* result = new IconResult{ workDir, item.index, icon, overlay, generation, item.name };
+            if (!::PostMessage(hListWnd, EXM_UPDATE_ICON_RESULT, 0, (LPARAM)result)) {
+                delete result;
+            }
+        }
+    });
 }
 
-void TaskTreeViewFetchIcons::OnCompleted() {
-    if (_treeCtrl && _hItem) {
-        _treeCtrl->SetItemIcons(_hItem, _icon, _iconSelected, _overlay);
+AsyncTask FetchTreeViewIconsAsync(WorkerThread& worker, TreeView* treeCtrl, HTREEITEM hItem, std::wstring path, DevType devType)
+{
+    struct Icons {
+        int icon{0};
+        int iconSelected{0};
+        int overlay{0};
+    };
+
+    const Icons icons = co_await RunOnWorker(worker, { .category = TaskCategory::TreeView, .viewKey = TreeItemKey(hItem) }, [path, devType] {
+        Icons icons;
+        FetchIcons(path.c_str(), nullptr, devType, &icons.icon, &icons.iconSelected, &icons.overlay);
+        return icons;
+    });
+
+    if (treeCtrl && hItem) {
+        treeCtrl->SetItemIcons(hItem, icons.icon, icons.iconSelected, icons.overlay);
     }
 }
-
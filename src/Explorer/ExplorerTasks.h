@@ -1,6 +1,7 @@
 #pragma once
 
-#include "WorkerThread.h"
+#include "AsyncTask.h"
+#include "DirectoryCache.h"
 #include "ExplorerModel.h"
 #include "Settings.h"
 #include "FileSystemService.h"
@@ -13,95 +14,28 @@
 #include <atomic>
 
 class ExplorerViewModel;
-
-class TaskCheckFolderChildren : public IAsyncTask {
-public:
-    TaskCheckFolderChildren(ExplorerViewModel* viewModel, HTREEITEM hItem, const std::wstring& path, Settings* settings);
-
-    void Execute() override;
-    void OnCompleted() override;
-    TaskCategory GetCategory() const override { return TaskCategory::TreeView; }
-
-private:
-    ExplorerViewModel* _viewModel;
-    HTREEITEM _hItem;
-    std::wstring _path;
-    Settings* _settings;
-    bool _hasChildren{false};
-};
-
-
-class TaskInit : public IAsyncTask {
-public:
-    TaskInit(std::shared_ptr<ExplorerModel> model, Settings* settings);
-
-    void Execute() override;
-    void OnCompleted() override;
-    TaskPriority GetPriority() const override { return TaskPriority::High; }
-    TaskCategory GetCategory() const override { return TaskCategory::TreeView; }
-
-private:
-    std::shared_ptr<ExplorerModel> _model;
-    Settings* _settings;
-    std::shared_ptr<ExplorerEntry> _root;
-};
-
-class TaskUpdateDirectory : public IAsyncTask {
-public:
-    TaskUpdateDirectory(std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, const std::wstring& path, Settings* settings, bool includeParent = false, ExplorerViewModel* viewModel = nullptr);
-
-    void Execute() override;
-    void OnCompleted() override;
-    TaskPriority GetPriority() const override { return TaskPriority::High; }
-    TaskCategory GetCategory() const override { return TaskCategory::TreeView; }
-
-private:
-    std::shared_ptr<ExplorerModel> _model;
-    std::shared_ptr<ExplorerEntry> _entry;
-    std::wstring _path;  // immutable value-copy, safe to read from worker thread
-    Settings* _settings;
-    std::vector<std::shared_ptr<ExplorerEntry>> _children;
-    bool _includeParent;
-    ExplorerViewModel* _viewModel;
-};
-
-class FileList;
-class ExplorerViewModel;
+class TreeView;
 struct IconWorkItem;
+struct FolderProbe;
 
-class TaskFetchIcons : public IAsyncTask {
-public:
-    TaskFetchIcons(FileList* fileList, HWND hListWnd, const std::wstring& workDir, std::vector<IconWorkItem>&& workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation);
+// Asynchronous operations of the explorer. Each one starts on the UI thread,
+// runs its file system work on the worker and finishes on the UI thread.
+// All parameters are taken by value because the coroutines outlive the call.
 
-    void Execute() override;
-    void OnCompleted() override;
-    TaskCategory GetCategory() const override { return TaskCategory::FileList; }
+// Answers what the cache knows at once and probes the rest with a single worker step.
+AsyncTask CheckFolderChildrenAsync(WorkerThread& worker, DirectoryCache* cache, ExplorerViewModel* viewModel, std::vector<FolderProbe> probes, Settings* settings, TaskPriority priority);
 
-private:
-    FileList* _fileList;
-    HWND _hListWnd;
-    std::wstring _workDir;
-    std::vector<IconWorkItem> _vWorkItems;
-    std::shared_ptr<std::atomic<bool>> _cancelToken;
-    uint64_t _generation;
-};
+AsyncTask InitModelAsync(WorkerThread& worker, std::shared_ptr<ExplorerModel> model, Settings* settings);
 
-class TreeView;
+// Serves a cached listing at once and then re-reads the directory in the
+// background; the entry is updated a second time only if the listing changed.
+AsyncTask UpdateDirectoryAsync(WorkerThread& worker, IDispatcher* dispatcher, DirectoryCache* cache, std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, std::wstring path, Settings* settings, bool includeParent = false, ExplorerViewModel* viewModel = nullptr);
 
-class TaskTreeViewFetchIcons : public IAsyncTask {
-public:
-    TaskTreeViewFetchIcons(TreeView* treeCtrl, HTREEITEM hItem, const std::wstring& path, DevType devType);
+// Reads an uncached directory in growing chunks and hands each one to the
+// view model while the rest is still being read; the complete listing is
+// cached and published like UpdateDirectoryAsync() would.
+AsyncTask StreamDirectoryAsync(WorkerThread& worker, DirectoryCache* cache, std::shared_ptr<ExplorerModel> model, std::shared_ptr<ExplorerEntry> entry, std::wstring path, Settings* settings, bool includeParent, ExplorerViewModel* viewModel);
 
-    void Execute() override;
-    void OnCompleted() override;
-    TaskCategory GetCategory() const override { return TaskCategory::TreeView; }
+AsyncTask FetchFileListIconsAsync(WorkerThread& worker, HWND hListWnd, std::wstring workDir, std::vector<IconWorkItem> workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation);
 
-private:
-    TreeView* _treeCtrl;
-    HTREEITEM _hItem;
-    std::wstring _path;
-    DevType _devType;
-    int _icon{0};
-    int _iconSelected{0};
-    int _overlay{0};
-};
+AsyncTask FetchTreeViewIconsAsync(WorkerThread& worker, TreeView* treeCtrl, HTREEITEM hItem, std::wstring path, DevType devType);
@@ -24,9 +24,17 @@
 #include "ExplorerTasks.h"
 #include "ExplorerResource.h"
 #include <algorithm>
+#include <unordered_set>
 #include <shellapi.h>
 
 namespace {
+// Number of file list rows handled by one icon task. Small enough that a
+// scroll is noticed quickly, large enough to keep the queue short.
+constexpr size_t ICON_TASK_CHUNK_SIZE = 32;
+
+// Number of folders probed by one has-children task.
+constexpr size_t PROBE_TASK_CHUNK_SIZE = 64;
+
 std::wstring ExpandEnvironmentVariables(const std::wstring& input)
 {
     DWORD size = ::ExpandEnvironmentStringsW(input.c_str(), nullptr, 0);
@@ -42,6 +50,11 @@ std::wstring ExpandEnvironmentVariables(const std::wstring& input)
     result.pop_back();
     return result;
 }
+
+std::wstring ParentPathOf(const std::filesystem::path& path)
+{
+    return path.parent_path().wstring();
+}
 } // namespace
 
 ExplorerViewModel::ExplorerViewModel(std::shared_ptr<ExplorerModel> model, Settings* settings, IDispatcher* dispatcher)
@@ -49,6 +62,28 @@ ExplorerViewModel::ExplorerViewModel(std::shared_ptr<ExplorerModel> model, Setti
 {
     _model->AddObserver(this);
     _historyItr = _history.end();
+
+    // Keep cached listings honest: any change below the watched directory
+    // drops the listing of the directory that contains it.
+    _directoryWatcher.Created([this](const std::filesystem::path& path) {
+        _directoryCache.Invalidate(ParentPathOf(path));
+    });
+    _directoryWatcher.Deleted([this](const std::filesystem::path& path) {
+        _directoryCache.Invalidate(ParentPathOf(path));
+        _directoryCache.InvalidateTree(path.wstring());
+    });
+    _directoryWatcher.Renamed([this](const std::filesystem::path& oldPath, const std::filesystem::path& newPath) {
+        _directoryCache.Invalidate(ParentPathOf(oldPath));
+        _directoryCache.InvalidateTree(oldPath.wstring());
+        _directoryCache.Invalidate(ParentPathOf(newPath));
+    });
+    _directoryWatcher.Modified([this](const std::filesystem::path& path) {
+        _directoryCache.Invalidate(ParentPathOf(path));
+    });
+    _directoryWatcher.Overflowed([this]() {
+        _directoryCache.Clear();
+    });
+
     _workerThread.Start(this);
 }
 
@@ -59,6 +94,7 @@ ExplorerViewModel::~ExplorerViewModel()
         _cancelToken->store(true);
     }
     _workerThread.Stop();
+    _directoryWatcher.Stop();
 }
 
 void ExplorerViewModel::AddObserver(IExplorerViewModelObserver* observer)
@@ -122,7 +158,7 @@ void ExplorerViewModel::NavigateTo(const std::wstring& path, bool recordHistory)
         }
 
         NavigationState state;
-        state.path = targetPath;
+        state.path = PathTable::Instance().Intern(targetPath);
         _history.push_back(state);
         _historyItr = _history.end() - 1;
     }
@@ -141,15 +177,16 @@ void ExplorerViewModel::NavigateTo(const std::wstring& path, bool recordHistory)
     _currentGeneration++;
 
     ClearPendingTasks(TaskCategory::FileList);
+    ClearPendingTasks(TaskCategory::FileListIcons);
 
-    UpdateCurrentDirectory();
+    UpdateCurrentDirectory(true);
 }
 
 void ExplorerViewModel::NavigateBack()
 {
     if (CanNavigateBack()) {
         _historyItr--;
-        NavigateTo(_historyItr->path, false);
+        NavigateTo(PathTable::Instance().ToString(_historyItr->path), false);
     }
 }
 
@@ -157,7 +194,7 @@ void ExplorerViewModel::NavigateForward()
 {
     if (CanNavigateForward()) {
         _historyItr++;
-        NavigateTo(_historyItr->path, false);
+        NavigateTo(PathTable::Instance().ToString(_historyItr->path), false);
     }
 }
 
@@ -179,7 +216,7 @@ INT ExplorerViewModel::GetBackHistory(LPTSTR* pszPathes) const
         while (itr != _history.begin()) {
             itr--;
             if (pszPathes) {
-                wcscpy(pszPathes[i], itr->path.c_str());
+                wcscpy(pszPathes[i], PathTable::Instance().ToString(itr->path).c_str());
             }
             i++;
         }
@@ -195,7 +232,7 @@ INT ExplorerViewModel::GetForwardHistory(LPTSTR* pszPathes) const
         while (itr != _history.end() - 1) {
             itr++;
             if (pszPathes) {
-                wcscpy(pszPathes[i], itr->path.c_str());
+                wcscpy(pszPathes[i], PathTable::Instance().ToString(itr->path).c_str());
             }
             i++;
         }
@@ -207,73 +244,34 @@ void ExplorerViewModel::NavigateToHistoryOffset(int offset)
 {
     if (!_history.empty()) {
         _historyItr += offset;
-        NavigateTo(_historyItr->path, false);
-    }
-}
-
-namespace {
-    bool UpdatePathPrefix(std::wstring& path, const std::wstring& oldPrefix, const std::wstring& newPrefix)
-    {
-        auto normalize = [](std::wstring p) {
-            if (!p.empty() && p.back() == L'\\') {
-                p.pop_back();
-            }
-            return p;
-        };
-
-        std::wstring normPath = normalize(path);
-        std::wstring normOld = normalize(oldPrefix);
-
-        if (normOld.empty()) {
-            return false;
-        }
-
-        auto equalsIgnoreCase = [](const std::wstring& s1, const std::wstring& s2) {
-            if (s1.size() != s2.size()) return false;
-            return std::equal(s1.begin(), s1.end(), s2.begin(), [](wchar_t c1, wchar_t c2) {
-                return std::towlower(c1) == std::towlower(c2);
-            });
-        };
-
-        auto startsWithIgnoreCase = [](const std::wstring& str, const std::wstring& prefix) {
-            if (str.size() < prefix.size()) return false;
-            return std::equal(prefix.begin(), prefix.end(), str.begin(), [](wchar_t c1, wchar_t c2) {
-                return std::towlower(c1) == std::towlower(c2);
-            });
-        };
-
-        if (equalsIgnoreCase(normPath, normOld)) {
-            path = newPrefix;
-            return true;
-        }
-
-        std::wstring matchPrefix = normOld + L"\\";
-        if (startsWithIgnoreCase(normPath, matchPrefix)) {
-            std::wstring relative = path.substr(matchPrefix.length());
-            std::wstring result = newPrefix;
-            if (!result.empty() && result.back() != L'\\') {
-                result += L'\\';
-            }
-            result += relative;
-            path = result;
-            return true;
-        }
-
-        return false;
+        NavigateTo(PathTable::Instance().ToString(_historyItr->path), false);
     }
 }
 
 void ExplorerViewModel::OnParentDirectoryRenamed(const std::wstring& oldPath, const std::wstring& newPath)
 {
+    PathTable& pathTable = PathTable::Instance();
+    const PathId oldId = pathTable.Intern(oldPath);
+    const PathId newId = pathTable.Intern(newPath);
+
     // Update current directory if it or its parent was renamed
-    if (UpdatePathPrefix(_currentDir, oldPath, newPath)) {
+    const PathId currentId = pathTable.Rebase(pathTable.Intern(_currentDir), oldId, newId);
+    if (currentId != INVALID_PATH_ID) {
+        const bool hasTrailingSlash = !_currentDir.empty() && _currentDir.back() == L'\\';
+        _currentDir = pathTable.ToString(currentId);
+        if (hasTrailingSlash && _currentDir.back() != L'\\') {
+            _currentDir += L'\\';
+        }
         _settings->SetCurrentDir(_currentDir);
         NotifyCurrentDirectoryChanged();
     }
 
     // Update history entries that are affected by this rename
     for (auto& state : _history) {
-        UpdatePathPrefix(state.path, oldPath, newPath);
+        const PathId movedId = pathTable.Rebase(state.path, oldId, newId);
+        if (movedId != INVALID_PATH_ID) {
+            state.path = movedId;
+        }
     }
 }
 
@@ -297,7 +295,7 @@ std::wstring ExplorerViewModel::GetCurrentDir() const
     return _currentDir;
 }
 
-void ExplorerViewModel::UpdateCurrentDirectory()
+void ExplorerViewModel::UpdateCurrentDirectory(bool streamListing)
 {
     // Determine if parent entry ".." should be included
     std::filesystem::path current(_currentDir);
@@ -305,11 +303,28 @@ void ExplorerViewModel::UpdateCurrentDirectory()
     bool includeParent = _settings->IsPathInWorkspace(parentPath);
 
     // Create/reuse the entry for the current directory
-    _currentDirEntry = std::make_shared<ExplorerEntry>(
+    _currentDirEntry = ExplorerEntry::Create(
         _currentDir,
         FileSystemEntry(_currentDir, FILE_ATTRIBUTE_DIRECTORY, 0, 0, false));
 
-    EnqueueAsyncTask(std::make_unique<TaskUpdateDirectory>(_model, _currentDirEntry, _currentDir, _settings, includeParent, this));
+    WatchDirectory(_currentDir);
+    if (streamListing && !_directoryCache.Peek(_currentDir)) {
+        // Nothing to show yet: let the list fill while a huge folder is still being read.
+        StreamDirectoryAsync(_workerThread, &_directoryCache, _model, _currentDirEntry, _currentDir, _settings, includeParent, this);
+    } else {
+        UpdateDirectoryAsync(_workerThread, _dispatcher, &_directoryCache, _model, _currentDirEntry, _currentDir, _settings, includeParent, this);
+    }
+}
+
+void ExplorerViewModel::WatchDirectory(const std::wstring& path)
+{
+    std::wstring directory = path;
+    if (!directory.empty() && directory.back() != L'\\') {
+        directory += L'\\';
+    }
+    if (_wcsicmp(directory.c_str(), _directoryWatcher.Directory().c_str()) != 0) {
+        _directoryWatcher.Reset(directory);
+    }
 }
 
 void ExplorerViewModel::OnEntryUpdated(std::shared_ptr<ExplorerEntry> entry)
@@ -329,6 +344,7 @@ void ExplorerViewModel::Refresh()
     _currentGeneration++;
 
     ClearPendingTasks(TaskCategory::FileList);
+    ClearPendingTasks(TaskCategory::FileListIcons);
 
     UpdateCurrentDirectory();
 }
@@ -337,6 +353,8 @@ void ExplorerViewModel::SetFilter(const std::wstring& filter)
 {
     _filter = filter;
     _settings->GetFileFilter().setFilter(filter.c_str());
+    // Remembered has-children answers were given under the old filter
+    _directoryCache.ClearHasChildren(_settings->GetFileFilter().getGeneration());
     Refresh();
 }
 
@@ -345,11 +363,6 @@ std::wstring ExplorerViewModel::GetFilter() const
     return _filter;
 }
 
-void ExplorerViewModel::EnqueueAsyncTask(std::unique_ptr<IAsyncTask> task)
-{
-    _workerThread.Enqueue(std::move(task));
-}
-
 void ExplorerViewModel::ClearPendingTasks(std::optional<TaskCategory> category)
 {
     _workerThread.ClearPendingTasks(category);
@@ -389,6 +402,18 @@ void ExplorerViewModel::NotifyEntriesLoaded(const std::vector<std::shared_ptr<Ex
     }
 }
 
+void ExplorerViewModel::NotifyEntriesAppended(const std::vector<std::shared_ptr<ExplorerEntry>>& entries)
+{
+    std::vector<IExplorerViewModelObserver*> observersCopy;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        observersCopy = _observers;
+    }
+    for (auto* observer : observersCopy) {
+        observer->OnDirectoryEntriesAppended(_currentDir, entries);
+    }
+}
+
 void ExplorerViewModel::NotifyNavigationStateChanged()
 {
     std::vector<IExplorerViewModelObserver*> observersCopy;
@@ -557,22 +582,70 @@ std::optional<std::wstring> ExplorerViewModel::ResolveAndValidateDirectory(const
     return std::nullopt;
 }
 
-void ExplorerViewModel::CheckFolderChildren(HTREEITEM hItem, const std::wstring& path)
+void ExplorerViewModel::CheckFolderChildren(std::vector<FolderProbe> probes, TaskPriority priority)
 {
-    EnqueueAsyncTask(std::make_unique<TaskCheckFolderChildren>(this, hItem, path, _settings));
+    for (size_t begin = 0; begin < probes.size(); begin += PROBE_TASK_CHUNK_SIZE) {
+        const size_t end = std::min(begin + PROBE_TASK_CHUNK_SIZE, probes.size());
+        std::vector<FolderProbe> chunk(std::make_move_iterator(probes.begin() + begin), std::make_move_iterator(probes.begin() + end));
+        CheckFolderChildrenAsync(_workerThread, &_directoryCache, this, std::move(chunk), _settings, priority);
+    }
 }
 
 void ExplorerViewModel::FetchFileListIcons(FileList* fileList, HWND hListWnd, const std::wstring& workDir, std::vector<IconWorkItem>&& workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation)
 {
-    EnqueueAsyncTask(std::make_unique<TaskFetchIcons>(fileList, hListWnd, workDir, std::move(workItems), cancelToken, generation));
+    // The list asks for the rows around its viewport only; what is still
+    // queued for rows it scrolled away from is dropped.
+    ClearPendingTasks(TaskCategory::FileListIcons);
+
+    // Split the work into row chunks so that the chunks under the viewport can
+    // be moved ahead of the rest when the list is scrolled.
+    for (size_t begin = 0; begin < workItems.size(); begin += ICON_TASK_CHUNK_SIZE) {
+        const size_t end = std::min(begin + ICON_TASK_CHUNK_SIZE, workItems.size());
+        std::vector<IconWorkItem> chunk(std::make_move_iterator(workItems.begin() + begin), std::make_move_iterator(workItems.begin() + end));
+        FetchFileListIconsAsync(_workerThread, hListWnd, workDir, std::move(chunk), cancelToken, generation);
+    }
+}
+
+void ExplorerViewModel::PrioritizeFileListRows(int firstVisible, int lastVisible)
+{
+    if (lastVisible < firstVisible) {
+        return;
+    }
+    // One page above and below the viewport is fetched next, so that scrolling
+    // by a page already finds its icons. Rows beyond that are a guess and only
+    // run when nothing else is queued.
+    const intptr_t page = static_cast<intptr_t>(lastVisible) - firstVisible + 1;
+    const intptr_t nearFirst = firstVisible - page;
+    const intptr_t nearLast = lastVisible + page;
+    _workerThread.Reprioritize(TaskCategory::FileListIcons, [=](const TaskViewKey& key) {
+        if (key.first <= lastVisible && firstVisible <= key.last) {
+            return TaskPriority::Visible;
+        }
+        if (key.first <= nearLast && nearFirst <= key.last) {
+            return TaskPriority::NearVisible;
+        }
+        return TaskPriority::Speculative;
+    });
+}
+
+void ExplorerViewModel::PrioritizeTreeItems(const std::vector<HTREEITEM>& visibleItems)
+{
+    std::unordered_set<intptr_t> visible;
+    visible.reserve(visibleItems.size());
+    for (HTREEITEM hItem : visibleItems) {
+        visible.insert(reinterpret_cast<intptr_t>(hItem));
+    }
+    _workerThread.Reprioritize(TaskCategory::TreeView, [&](const TaskViewKey& key) {
+        return visible.contains(key.first) ? TaskPriority::Visible : TaskPriority::Background;
+    });
 }
 
 void ExplorerViewModel::FetchTreeViewIcons(TreeView* treeCtrl, HTREEITEM hItem, const std::wstring& path, DevType devType)
 {
-    EnqueueAsyncTask(std::make_unique<TaskTreeViewFetchIcons>(treeCtrl, hItem, path, devType));
+    FetchTreeViewIconsAsync(_workerThread, treeCtrl, hItem, path, devType);
 }
 
-void ExplorerViewModel::OnFolderChildrenChecked(HTREEITEM hItem, const std::wstring& path, bool hasChildren)
+void ExplorerViewModel::OnFolderChildrenChecked(const FolderProbe& probe, bool hasChildren)
 {
     std::vector<IExplorerViewModelObserver*> observersCopy;
     {
@@ -580,18 +653,25 @@ void ExplorerViewModel::OnFolderChildrenChecked(HTREEITEM hItem, const std::wstr
         observersCopy = _observers;
     }
     for (auto* observer : observersCopy) {
-        observer->OnFolderChildrenChecked(hItem, path, hasChildren);
+        observer->OnFolderChildrenChecked(probe, hasChildren);
+    }
+}
+
+void ExplorerViewModel::OnEntryChildrenAppended(std::shared_ptr<ExplorerEntry> entry, const std::vector<std::shared_ptr<ExplorerEntry>>& appended)
+{
+    if (_currentDirEntry && entry == _currentDirEntry) {
+        NotifyEntriesAppended(appended);
     }
 }
 
 void ExplorerViewModel::InitModel()
 {
-    EnqueueAsyncTask(std::make_unique<TaskInit>(_model, _settings));
+    InitModelAsync(_workerThread, _model, _settings);
 }
 
 void ExplorerViewModel::UpdateDirectory(std::shared_ptr<ExplorerEntry> entry, const std::wstring& path, bool includeParent)
 {
-    EnqueueAsyncTask(std::make_unique<TaskUpdateDirectory>(_model, entry, path, _settings, includeParent));
+    UpdateDirectoryAsync(_workerThread, _dispatcher, &_directoryCache, _model, entry, path, _settings, includeParent);
 }
 
 void ExplorerViewModel::StopWorkerThread()
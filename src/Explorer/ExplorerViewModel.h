@@ -31,6 +31,9 @@
 #include <windows.h>
 
 #include "WorkerThread.h"
+#include "DirectoryCache.h"
+#include "FileSystemWatcher.h"
+#include "PathTable.h"
 #include "ExplorerModel.h"
 #include "IDispatcher.h"
 #include "Settings.h"
@@ -63,10 +66,18 @@ struct EntryRenamedEvent {
 class IExplorerViewModelObserver;
 
 struct NavigationState {
-    std::wstring path;
+    PathId path{INVALID_PATH_ID};
     std::vector<std::wstring> selectedItems;
 };
 
+// A tree folder whose has-children state is to be determined.
+struct FolderProbe {
+    HTREEITEM hItem;
+    std::wstring path;
+    time_t lastWriteTime;
+    unsigned int generation;    // probe generation of the tree when the probe was queued
+};
+
 class FileList;
 class TreeView;
 struct IconWorkItem;
@@ -83,7 +94,7 @@ public:
     std::optional<std::wstring> ResolveAndValidateDirectory(const std::wstring& input);
     void InitModel();
     void UpdateDirectory(std::shared_ptr<ExplorerEntry> entry, const std::wstring& path, bool includeParent = false);
-    void UpdateCurrentDirectory();
+    void UpdateCurrentDirectory(bool streamListing = false);
     void StopWorkerThread();
 
     void AddObserver(IExplorerViewModelObserver* observer);
@@ -112,6 +123,7 @@ public:
     // View data getters
     std::wstring GetCurrentDir() const;
     std::shared_ptr<ExplorerEntry> GetCurrentDirEntry() const { return _currentDirEntry; }
+    const DirectoryCache& GetDirectoryCache() const { return _directoryCache; }
 
     // Commands
     void Refresh();
@@ -150,27 +162,35 @@ public:
     }
 
     // Async Task requests from View
-    void CheckFolderChildren(HTREEITEM hItem, const std::wstring& path);
+    void CheckFolderChildren(std::vector<FolderProbe> probes, TaskPriority priority);
     void FetchFileListIcons(FileList* fileList, HWND hListWnd, const std::wstring& workDir, std::vector<IconWorkItem>&& workItems, std::shared_ptr<std::atomic<bool>> cancelToken, uint64_t generation);
     void FetchTreeViewIcons(TreeView* treeCtrl, HTREEITEM hItem, const std::wstring& path, DevType devType);
 
+    // Re-rank queued work after the view scrolled
+    void PrioritizeFileListRows(int firstVisible, int lastVisible);
+    void PrioritizeTreeItems(const std::vector<HTREEITEM>& visibleItems);
+
     // IAsyncTaskCallback implementation
     void OnAsyncTaskCompleted(std::unique_ptr<IAsyncTask> task) override;
 
     // Asynchronous callbacks from task completions
-    void OnFolderChildrenChecked(HTREEITEM hItem, const std::wstring& path, bool hasChildren);
+    void OnFolderChildrenChecked(const FolderProbe& probe, bool hasChildren);
+    void OnEntryChildrenAppended(std::shared_ptr<ExplorerEntry> entry, const std::vector<std::shared_ptr<ExplorerEntry>>& appended);
 
 private:
-    void EnqueueAsyncTask(std::unique_ptr<IAsyncTask> task);
     void ClearPendingTasks(std::optional<TaskCategory> category = std::nullopt);
     void NotifyCurrentDirectoryChanged();
     void NotifyEntriesLoaded(const std::vector<std::shared_ptr<ExplorerEntry>>& entries);
+    void NotifyEntriesAppended(const std::vector<std::shared_ptr<ExplorerEntry>>& entries);
     void NotifyNavigationStateChanged();
     std::wstring PreprocessInput(const std::wstring& input) const;
     std::wstring ResolveToAbsolutePath(const std::wstring& expandedInput) const;
+    void WatchDirectory(const std::wstring& path);
 
     std::shared_ptr<ExplorerModel> _model;
     Settings* _settings;
+    DirectoryCache _directoryCache;
+    FileSystemWatcher _directoryWatcher;
     WorkerThread _workerThread;
 
     std::wstring _currentDir;
@@ -198,7 +218,9 @@ public:
     virtual void OnNavigationStateChanged() = 0;
     virtual void OnCommandExecutionFailed(const std::wstring& command) = 0;
     virtual void OnToggleWorkspaceModeRequested() = 0;
-    virtual void OnFolderChildrenChecked(HTREEITEM hItem, const std::wstring& path, bool hasChildren) {}
+    virtual void OnFolderChildrenChecked(const FolderProbe& probe, bool hasChildren) {}
+    // A chunk of a listing that is still being read; OnDirectoryEntriesLoaded() follows with all entries.
+    virtual void OnDirectoryEntriesAppended(const std::wstring& path, const std::vector<std::shared_ptr<ExplorerEntry>>& entries) {}
 
     // Event handler overloads
     virtual std::optional<std::wstring> handle(const PromptForNameEvent& ev) { return std::nullopt; }
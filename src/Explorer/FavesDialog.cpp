@@ -195,8 +195,11 @@ INT_PTR CALLBACK FavesDialog::run_dlgProc(UINT Message, WPARAM wParam, LPARAM lP
                     if (pElem == nullptr) {
                         break;
                     }
-                    // update expand state
+                    // update expand state; restoring the saved state changes nothing to save
                     pElem->IsExpanded(!pElem->IsExpanded());
+                    if (!_isRestoringExpandState) {
+                        ScheduleSave();
+                    }
 
                     // reload session's children
                     if ((pElem->Type() == FavesType::Session) && pElem->IsLink()) {
@@ -587,6 +590,7 @@ void FavesDialog::PasteItem(HTREEITEM hItem)
         }
 
         _hTreeCutCopy = nullptr;
+        ScheduleSave();
     }
     else {
         std::wstring msgBoxTxt = std::format(L"Could only be paste into {}", source->Root()->Name());
@@ -632,6 +636,7 @@ void FavesDialog::AddToFavorites(bool isFolder, const std::wstring& link)
 
         auto *item = _hTreeCtrl.FindTreeItemByParam(group);
         RefreshTree(item);
+        ScheduleSave();
     }
 }
 
@@ -669,6 +674,7 @@ void FavesDialog::AddToFavorites(bool isFolder, std::vector<std::wstring>&& path
 
             auto *item = _hTreeCtrl.FindTreeItemByParam(group);
             RefreshTree(item);
+            ScheduleSave();
         }
     }
 }
@@ -744,6 +750,7 @@ void FavesDialog::AddSaveSession(HTREEITEM hItem, bool bSave)
             UpdateLink(hParentItem);
             _hTreeCtrl.Expand(hParentItem, TVM_EXPAND | TVE_COLLAPSERESET);
         }
+        ScheduleSave();
     }
 }
 
@@ -781,6 +788,7 @@ void FavesDialog::NewItem(HTREEITEM hItem)
         UpdateLink(hItem);
 
         _hTreeCtrl.Expand(hItem, TVM_EXPAND | TVE_COLLAPSERESET);
+        ScheduleSave();
     }
 }
 
@@ -840,6 +848,7 @@ void FavesDialog::EditItem(HTREEITEM hItem)
         /* update text of item */
         if (needsUpdate) {
             UpdateLink(hParentItem);
+            ScheduleSave();
         }
     }
 }
@@ -863,6 +872,7 @@ void FavesDialog::DeleteItem(HTREEITEM hItem)
 
     pElem->Remove();
     _hTreeCtrl.DeleteItem(hItem);
+    ScheduleSave();
 
     /* update only parent of parent when current item is a group folder */
     if (reinterpret_cast<FavesItem*>(_hTreeCtrl.GetParam(hItemParent))->IsGroup()) {
@@ -951,6 +961,7 @@ void FavesDialog::OpenGroupContext(HTREEITEM hItem, POINT pt, FavesItem* pElem)
             }
             UpdateLink(hItem);
             _hTreeCtrl.Expand(hItem, TVM_EXPAND | TVE_COLLAPSERESET);
+            ScheduleSave();
         }
         break;
     }
@@ -1115,7 +1126,9 @@ void FavesDialog::UpdateLink(HTREEITEM hParentItem)
             /* toggle if state is not equal */
             if (isTreeExp != child->IsExpanded()) {
                 child->IsExpanded(isTreeExp);
+                _isRestoringExpandState = true;
                 _hTreeCtrl.Expand(hCurrentItem, TVE_TOGGLE);
+                _isRestoringExpandState = false;
             }
 
             /* in any case redraw the session children items */
@@ -1286,7 +1299,9 @@ void FavesDialog::ExpandElementsRecursive(HTREEITEM hItem)
                 /* if node needs to be expand, delete the indicator first,
                    because TreeView Expand() function toggles the flag     */
                 pElem->IsExpanded(!pElem->IsExpanded());
+                _isRestoringExpandState = true;
                 _hTreeCtrl.Expand(hCurrentItem, TVE_TOGGLE);
+                _isRestoringExpandState = false;
             }
 
             /* traverse into the tree */
@@ -1297,32 +1312,59 @@ void FavesDialog::ExpandElementsRecursive(HTREEITEM hItem)
     }
 }
 
-void FavesDialog::ReadSettings()
+std::filesystem::path FavesDialog::GetFavoritesPath() const
 {
     std::filesystem::path favorites_dat(_pSettings->GetConfigDir());
     favorites_dat /= FAVES_DATA;
+    return favorites_dat;
+}
 
-    if (!std::filesystem::exists(favorites_dat)) {
-        _model.Clear();
-        return;
+void FavesDialog::ReadSettings()
+{
+    const std::filesystem::path favorites_dat = GetFavoritesPath();
+
+    /* the newest version that reads completely wins: the file itself, else its backups */
+    std::string error;
+    for (int generation = 0; generation <= FavesSaver::BACKUP_COUNT; generation++) {
+        const std::filesystem::path path = (generation == 0) ? favorites_dat : FavesSaver::BackupPath(favorites_dat, generation);
+        if (!std::filesystem::exists(path)) {
+            continue;
+        }
+        try {
+            _model.Load(path);
+            if (generation == 0) {
+                _saver.SetBaseline(_model.Serialize());
+            }
+            return;
+        }
+        catch (const std::exception& e) {
+            /* the backups are kept until a good file replaces the broken one */
+            if (generation == 0) {
+                _saver.MarkUnreadable();
+            }
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
     }
 
-    try {
-        _model.Load(favorites_dat);
-    }
-    catch (const std::exception& e) {
-        ::MessageBoxA(_hParent, e.what(), "Error", MB_OK | MB_ICONERROR);
+    _model.Clear();
+    if (!error.empty()) {
+        ::MessageBoxA(_hParent, error.c_str(), "Error", MB_OK | MB_ICONERROR);
     }
 }
 
+void FavesDialog::ScheduleSave()
+{
+    _saver.Schedule(GetFavoritesPath(), _model.Serialize());
+}
+
 void FavesDialog::SaveSettings()
 {
-    std::filesystem::path favorites_dat(_pSettings->GetConfigDir());
-    favorites_dat /= FAVES_DATA;
-    try {
-        _model.Save(favorites_dat);
-    }
-    catch (const std::exception& e) {
-        ::MessageBoxA(_hParent, e.what(), "Error", MB_OK | MB_ICONERROR);
+    const std::filesystem::path favorites_dat = GetFavoritesPath();
+    _saver.Schedule(favorites_dat, _model.Serialize());
+    if (!_saver.Stop()) {
+        std::wstring msgBoxTxt = std::format(L"Failed to write file: {}", favorites_dat.wstring());
+        ::MessageBox(_hParent, msgBoxTxt.c_str(), L"Error", MB_OK | MB_ICONERROR);
     }
 }
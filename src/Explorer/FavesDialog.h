@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "Explorer.h"
 #include "FavesModel.h"
+#include "FavesSaver.h"
 #include "TreeView.h"
 #include "ToolBar.h"
 #include "../NppPlugin/DockingFeature/DockingDlgInterface.h"
@@ -112,7 +113,11 @@ protected:
 
     void DrawSessionChildren(HTREEITEM hItem);
 
+    std::filesystem::path GetFavoritesPath() const;
     void ReadSettings();
+    /* hands a snapshot of the model to the background saver */
+    void ScheduleSave();
+    /* writes the model and waits for the file, used on shutdown */
     void SaveSettings();
 
     void ExpandElementsRecursive(HTREEITEM hItem);
@@ -142,11 +147,14 @@ private:
     ReBar           _Rebar;
 
     bool            _addToSession = false;
+    /* set while a toggle only brings the tree in line with the model, e.g. on startup */
+    bool            _isRestoringExpandState = false;
     FavesItem*      _peOpenLink = nullptr;
     Settings*       _pSettings = nullptr;
     IPluginContext* _pluginContext = nullptr;
 
     /* database */
     FavesModel      _model;
+    FavesSaver      _saver;
     TreeView        _hTreeCtrl;
 };
@@ -90,11 +90,10 @@ FavesItem* FavesModel::RootByType(FavesType type) const
 void FavesModel::Load(const std::filesystem::path &path) {
 
     auto ReadPropertyString = [](Utf16Reader& file, std::wstring_view property) -> std::wstring {
-        if (file.eof()) {
-            return {};
-        }
         std::wstring line;
-        file.getline(line);
+        if (file.eof() || !file.getline(line)) {
+            throw std::runtime_error("Invalid format: file ends inside an item");
+        }
         size_t pos = line.find_first_of(property);
         if (std::wstring::npos == pos) {
             throw std::runtime_error("Invalid format: expected prefix not found");
@@ -155,43 +154,48 @@ void FavesModel::Load(const std::filesystem::path &path) {
             }
         }
     }
+
+    // Every file we write starts with a root and closes its groups; anything else was cut short
+    if (root == nullptr) {
+        throw std::runtime_error("Invalid format: no favorites found");
+    }
+    if (!parents.empty()) {
+        throw std::runtime_error("Invalid format: file ends inside a group");
+    }
 }
 
-void FavesModel::Save(const std::filesystem::path& path) const
+std::wstring FavesModel::Serialize() const
 {
     auto BoolFrom = [](bool value) -> std::wstring_view {
         return value ? L"1" : L"0";
     };
-    
-    std::function<void(const FavesItem*, Utf16Writer&)> SaveItems = [&](const FavesItem* parent_item, Utf16Writer& file) -> void {
+
+    std::wstring text;
+    std::function<void(const FavesItem*)> SaveItems = [&](const FavesItem* parent_item) -> void {
         for (const auto& item : parent_item->Children()) {
             if (item->IsGroup()) {
-                file << GROUP_TAG << L"\n"
-                     << L"\t" << PROPERTY_NAME << item->Name() << L"\n"
-                     << L"\t" << PROPERTY_EXPAND << BoolFrom(item->IsExpanded()) << L"\n\n";
-                SaveItems(item.get(), file);
-                file << END_TAG << L"\n\n";
+                text.append(GROUP_TAG).append(L"\n")
+                    .append(L"\t").append(PROPERTY_NAME).append(item->Name()).append(L"\n")
+                    .append(L"\t").append(PROPERTY_EXPAND).append(BoolFrom(item->IsExpanded())).append(L"\n\n");
+                SaveItems(item.get());
+                text.append(END_TAG).append(L"\n\n");
             }
             else if (item->IsLink()) {
-                file << LINK_TAG << L"\n"
-                     << L"\t" << PROPERTY_NAME << item->Name() << L"\n"
-                     << L"\t" << PROPERTY_LINK << item->Link() << L"\n\n";
+                text.append(LINK_TAG).append(L"\n")
+                    .append(L"\t").append(PROPERTY_NAME).append(item->Name()).append(L"\n")
+                    .append(L"\t").append(PROPERTY_LINK).append(item->Link()).append(L"\n\n");
             }
         }
     };
 
-    Utf16Writer file(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file for writing: " + path.string());
-    }
-
     for (const auto& root : m_roots) {
         if (root) {
-            file << root->Name() << L"\n"
-                 << L"Expand=" << BoolFrom(root->IsExpanded()) << L"\n\n";
-            SaveItems(root.get(), file);
+            text.append(root->Name()).append(L"\n")
+                .append(PROPERTY_EXPAND).append(BoolFrom(root->IsExpanded())).append(L"\n\n");
+            SaveItems(root.get());
         }
     }
+    return text;
 }
 
 
@@ -53,8 +53,10 @@ public:
     FavesItem* SessionRoot() const;
     FavesItem* RootByType(FavesType type) const;
 
+    /* throws std::runtime_error if the file cannot be read or is cut short */
     void Load(const std::filesystem::path& path);
-    void Save(const std::filesystem::path& path) const;
+    /* text of the favorites file, without the byte order mark */
+    std::wstring Serialize() const;
 private:
     std::array<std::unique_ptr<FavesItem>, 4> m_roots;
 };
@@ -0,0 +1,174 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "FavesSaver.h"
+
+#include <Windows.h>
+
+#include "UTF16Stream.h"
+
+namespace {
+constexpr auto SAVE_DELAY = std::chrono::milliseconds(500);
+}
+
+FavesSaver::~FavesSaver()
+{
+    Stop();
+}
+
+void FavesSaver::SetBaseline(std::wstring text)
+{
+    std::lock_guard lock(_mutex);
+    _written = std::move(text);
+}
+
+void FavesSaver::MarkUnreadable()
+{
+    std::lock_guard lock(_mutex);
+    _isCurrentReadable = false;
+    _written.clear();
+}
+
+void FavesSaver::Schedule(const std::filesystem::path& path, std::wstring text)
+{
+    {
+        std::lock_guard lock(_mutex);
+        if (!_writing && text == _written) {
+            _pending.reset();
+            return;
+        }
+        _path = path;
+        _pending = std::move(text);
+        _due = Clock::now() + SAVE_DELAY;
+        if (!_thread.joinable()) {
+            _stopping = false;
+            _thread = std::thread(&FavesSaver::Run, this);
+        }
+    }
+    _cv.notify_all();
+}
+
+bool FavesSaver::Flush()
+{
+    std::unique_lock lock(_mutex);
+    ++_flushing;
+    _cv.notify_all();
+    _cv.wait(lock, [this] { return !_pending && !_writing; });
+    --_flushing;
+    return _succeeded;
+}
+
+bool FavesSaver::Stop()
+{
+    const bool succeeded = Flush();
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    return succeeded;
+}
+
+std::filesystem::path FavesSaver::BackupPath(const std::filesystem::path& path, int generation)
+{
+    std::filesystem::path backup(path);
+    backup += (generation == 1) ? std::wstring(L".bak") : L".bak" + std::to_wstring(generation);
+    return backup;
+}
+
+std::filesystem::path FavesSaver::UnreadablePath(const std::filesystem::path& path)
+{
+    std::filesystem::path unreadable(path);
+    unreadable += L".unreadable";
+    return unreadable;
+}
+
+bool FavesSaver::WriteAtomically(const std::filesystem::path& path, std::wstring_view text, bool isCurrentReadable)
+{
+    /* the swap parks the old file under a scratch name; one left over from an interrupted write is stale */
+    std::filesystem::path replacedPath(path);
+    replacedPath += L".replaced";
+    ::DeleteFileW(replacedPath.c_str());
+
+    if (!WriteUtf16FileAtomically(path, text, replacedPath)) {
+        return false;
+    }
+    if (::GetFileAttributesW(replacedPath.c_str()) == INVALID_FILE_ATTRIBUTES) {
+        return true;
+    }
+
+    /* only now that the new file is in place are the backups shifted to make room for the old one */
+    if (!isCurrentReadable) {
+        ::MoveFileExW(replacedPath.c_str(), UnreadablePath(path).c_str(), MOVEFILE_REPLACE_EXISTING);
+        return true;
+    }
+    for (int generation = BACKUP_COUNT - 1; generation >= 1; --generation) {
+        ::MoveFileExW(BackupPath(path, generation).c_str(), BackupPath(path, generation + 1).c_str(), MOVEFILE_REPLACE_EXISTING);
+    }
+    ::MoveFileExW(replacedPath.c_str(), BackupPath(path).c_str(), MOVEFILE_REPLACE_EXISTING);
+    return true;
+}
+
+void FavesSaver::Run()
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this] { return _pending || _stopping; });
+        if (!_pending) {
+            return;
+        }
+
+        /* let a burst of edits settle, unless someone waits for the file */
+        while (_pending && _flushing == 0 && !_stopping && Clock::now() < _due) {
+            _cv.wait_until(lock, _due);
+        }
+        if (!_pending) {
+            _cv.notify_all();
+            continue;
+        }
+
+        std::wstring text = std::move(*_pending);
+        _pending.reset();
+        if (text == _written) {
+            _succeeded = true;
+            _cv.notify_all();
+            continue;
+        }
+
+        _writing = true;
+        const std::filesystem::path path = _path;
+        const bool isCurrentReadable = _isCurrentReadable;
+        lock.unlock();
+        const bool succeeded = WriteAtomically(path, text, isCurrentReadable);
+        lock.lock();
+        _writing = false;
+        _succeeded = succeeded;
+        if (succeeded) {
+            _written = std::move(text);
+            _isCurrentReadable = true;
+        }
+        _cv.notify_all();
+    }
+}
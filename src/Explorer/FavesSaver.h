@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// Writes favorites snapshots on a background thread, so that editing the tree
+// never waits for the disk. A write starts once the edits have paused for a
+// moment, and a snapshot that is still waiting is replaced by a newer one.
+// Each write goes through a temporary file that is swapped in only once it is
+// complete, and the replaced file becomes the newest of BACKUP_COUNT backups.
+class FavesSaver {
+public:
+    static constexpr int BACKUP_COUNT = 3;
+
+    FavesSaver() = default;
+    ~FavesSaver();
+    FavesSaver(const FavesSaver&) = delete;
+    FavesSaver& operator=(const FavesSaver&) = delete;
+
+    // Text that is already on disk; a snapshot equal to it is not written again
+    void SetBaseline(std::wstring text);
+    // The file on disk cannot be read: the next write sets it aside as UnreadablePath()
+    // instead of rotating it into the backups, which may hold the last good version
+    void MarkUnreadable();
+    void Schedule(const std::filesystem::path& path, std::wstring text);
+    // Waits until the waiting snapshot is written; returns false if the last write failed
+    bool Flush();
+    // Flushes and ends the thread; a later Schedule() starts it again
+    bool Stop();
+
+    // Earlier versions of the file, generation 1 is the newest (".bak", ".bak2", ...)
+    static std::filesystem::path BackupPath(const std::filesystem::path& path, int generation = 1);
+    static std::filesystem::path UnreadablePath(const std::filesystem::path& path);
+    static bool WriteAtomically(const std::filesystem::path& path, std::wstring_view text, bool isCurrentReadable = true);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Run();
+
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    std::thread             _thread;
+    std::filesystem::path   _path;
+    std::optional<std::wstring> _pending;
+    Clock::time_point       _due;
+    std::wstring            _written;
+    int                     _flushing{0};
+    bool                    _writing{false};
+    bool                    _stopping{false};
+    bool                    _succeeded{true};
+    bool                    _isCurrentReadable{true};
+};
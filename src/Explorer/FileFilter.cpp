@@ -24,8 +24,15 @@
 
 #include "FileFilter.h"
 
+#include <algorithm>
+#include <cwctype>
+#include <span>
+
 namespace {
 
+using Glob = std::vector<std::wstring>;
+using PathGlob = std::vector<std::vector<Glob>>;
+
 static std::wstring trim(const std::wstring& s)
 {
     const auto first = s.find_first_not_of(L" \t");
@@ -66,49 +73,224 @@ std::vector<std::wstring> split(const std::wstring_view& string, WCHAR delim)
     return result;
 }
 
-BOOL wildcmp(LPCTSTR wild, LPCTSTR string)
+/* ASCII names, by far the most common, are folded without a library call */
+WCHAR foldChar(WCHAR ch)
+{
+    if (ch < 0x80) {
+        return (L'A' <= ch && ch <= L'Z') ? static_cast<WCHAR>(ch + (L'a' - L'A')) : ch;
+    }
+    return static_cast<WCHAR>(std::towlower(ch));
+}
+
+std::wstring foldCase(std::wstring_view s)
+{
+    std::wstring folded(s);
+    std::transform(folded.begin(), folded.end(), folded.begin(), foldChar);
+    return folded;
+}
+
+/* lower case path with '/' separators, the form path patterns are compiled to */
+std::wstring foldPath(std::wstring_view directory, std::wstring_view name)
 {
-    // Written by Jack Handy - jakkhandy@hotmail.com
-    // See: http://www.codeproject.com/string/wildcmp.asp
-    LPCTSTR cp = nullptr;
-    LPCTSTR mp = nullptr;
+    std::wstring path = foldCase(directory);
+    std::replace(path.begin(), path.end(), L'\\', L'/');
+    while (!path.empty() && path.back() == L'/') {
+        path.pop_back();
+    }
+    path.push_back(L'/');
+    path.append(foldCase(name));
+    return path;
+}
 
-    while ((*string) && (*wild != '*')) {
-        if ((tolower(*wild) != tolower(*string)) && (*wild != '?')) {
-            return FALSE;
+std::vector<std::wstring_view> splitPath(std::wstring_view path)
+{
+    std::vector<std::wstring_view> segments;
+    size_t begin = 0;
+    while (begin < path.size()) {
+        size_t end = path.find(L'/', begin);
+        if (end == std::wstring_view::npos) {
+            end = path.size();
+        }
+        if (end > begin) {
+            segments.push_back(path.substr(begin, end - begin));
         }
-        wild++;
-        string++;
+        begin = end + 1;
     }
+    return segments;
+}
 
-    while (*string) {
-        if (*wild == '*') {
-            if (!*++wild) {
-                return TRUE;
+/*
+ * Matches items against runs separated by stars: the first run is anchored
+ * at the start, the last at the end and the ones in between are taken
+ * leftmost. As a star matches any sequence, the leftmost fit of a run never
+ * rules out a match, so no position is ever revisited.
+ */
+template <typename Item, typename Run, typename Equal>
+bool matchRuns(std::span<const Item> items, const std::vector<Run>& runs, Equal equal)
+{
+    auto matchRun = [&](size_t pos, const Run& run) {
+        for (size_t i = 0; i < run.size(); ++i) {
+            if (!equal(run[i], items[pos + i])) {
+                return false;
             }
-            mp = wild;
-            cp = string + 1;
         }
-        else if ((tolower(*wild) == tolower(*string)) || (*wild == '?')) {
-            wild++;
-            string++;
+        return true;
+    };
+
+    const Run& first = runs.front();
+    if (runs.size() == 1) {
+        return items.size() == first.size() && matchRun(0, first);
+    }
+
+    const Run& last = runs.back();
+    if (items.size() < first.size() + last.size()) {
+        return false;
+    }
+    if (!matchRun(0, first) || !matchRun(items.size() - last.size(), last)) {
+        return false;
+    }
+
+    size_t pos = first.size();
+    const size_t end = items.size() - last.size();
+    for (size_t i = 1; i + 1 < runs.size(); ++i) {
+        const Run& run = runs[i];
+        while (pos + run.size() <= end && !matchRun(pos, run)) {
+            pos++;
         }
-        else {
-            wild = mp;
-            string = cp++;
+        if (pos + run.size() > end) {
+            return false;
+        }
+        pos += run.size();
+    }
+    return true;
+}
+
+bool matchGlob(std::wstring_view name, const Glob& glob)
+{
+    return matchRuns(std::span<const WCHAR>(name.data(), name.size()), glob, [](WCHAR patternChar, WCHAR nameChar) {
+        return patternChar == L'?' || patternChar == nameChar;
+    });
+}
+
+bool matchPathGlob(std::span<const std::wstring_view> segments, const PathGlob& pathGlob)
+{
+    return matchRuns(segments, pathGlob, [](const Glob& glob, std::wstring_view segment) {
+        return matchGlob(segment, glob);
+    });
+}
+
+/* literal runs between stars; adjacent stars leave no empty run in the middle */
+Glob compileGlob(std::wstring_view pattern)
+{
+    Glob runs(1);
+    for (WCHAR ch : pattern) {
+        if (ch != L'*') {
+            runs.back().push_back(ch);
+        }
+        else if (!runs.back().empty() || runs.size() == 1) {
+            runs.emplace_back();
         }
     }
+    return runs;
+}
 
-    while (*wild == '*') {
-        wild++;
+/* folder name globs between "**"; a leading "**" is implied, so the pattern may match at any depth */
+PathGlob compilePathGlob(std::wstring_view pattern)
+{
+    PathGlob runs(2);
+    for (std::wstring_view segment : splitPath(pattern)) {
+        if (segment != L"**") {
+            runs.back().push_back(compileGlob(segment));
+        }
+        else if (!runs.back().empty()) {
+            runs.emplace_back();
+        }
     }
-    return !*wild;
+    return runs;
 }
 
 } // namespace
 
 
+void FileFilter::PatternSet::Compile(const std::vector<std::wstring>& patterns)
+{
+    for (const auto& pattern : patterns) {
+        const std::wstring folded = foldCase(pattern);
+        const size_t firstWild = folded.find_first_of(L"*?");
+
+        if (folded.find(L'/') != std::wstring::npos) {
+            pathGlobs.push_back(compilePathGlob(folded));
+        }
+        else if (folded.find_first_not_of(L'*') == std::wstring::npos) {
+            isMatchAll = true;
+        }
+        else if (folded.starts_with(L"*.") && folded.find_first_of(L"*?.", 2) == std::wstring::npos) {
+            extensionNames.push_back(folded.substr(2));
+        }
+        else if (folded.find(L'?') == std::wstring::npos && folded.find(L'*', firstWild + 1) == std::wstring::npos) {
+            if (firstWild == std::wstring::npos) {
+                affixes.push_back({ folded, L"", false });
+            }
+            else {
+                affixes.push_back({ folded.substr(0, firstWild), folded.substr(firstWild + 1), true });
+            }
+        }
+        else {
+            globs.push_back(compileGlob(folded));
+        }
+    }
+
+    /* the names are complete now, so the views stay valid */
+    for (const auto& extension : extensionNames) {
+        extensions.insert(extension);
+    }
+}
+
+bool FileFilter::PatternSet::Match(std::wstring_view name, std::wstring_view path) const
+{
+    if (isMatchAll) {
+        return true;
+    }
+
+    if (!extensions.empty()) {
+        const size_t dot = name.rfind(L'.');
+        if (dot != std::wstring_view::npos && extensions.contains(name.substr(dot + 1))) {
+            return true;
+        }
+    }
+
+    for (const auto& affix : affixes) {
+        if (affix.hasStar) {
+            if (name.size() >= affix.prefix.size() + affix.suffix.size() && name.starts_with(affix.prefix) && name.ends_with(affix.suffix)) {
+                return true;
+            }
+        }
+        else if (name == affix.prefix) {
+            return true;
+        }
+    }
+
+    for (const auto& glob : globs) {
+        if (matchGlob(name, glob)) {
+            return true;
+        }
+    }
+
+    if (!pathGlobs.empty()) {
+        const std::vector<std::wstring_view> segments = splitPath(path);
+        for (const auto& pathGlob : pathGlobs) {
+            if (matchPathGlob(std::span<const std::wstring_view>(segments), pathGlob)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
 FileFilter::FileFilter()
+    : _rules(std::make_shared<const Rules>())
 {
 }
 
@@ -127,60 +309,150 @@ void FileFilter::setFilter(std::wstring_view newFilter)
     const std::wstring_view DENY_BEGIN = L"[^";
     const std::wstring_view DENY_END   = L"]";
 
-    _allowList.clear();
-    _denyList.clear();
+    std::vector<std::wstring> allowList;
+    std::vector<std::wstring> denyList;
 
     SIZE_T denyBeginPos = _filterString.find_first_of(DENY_BEGIN);
     if (std::wstring::npos == denyBeginPos) {
-        _allowList = split(_filterString, SEPARATOR);
+        allowList = split(_filterString, SEPARATOR);
     }
     else {
         SIZE_T denyEndPos = _filterString.find_first_of(DENY_END, denyBeginPos);
         if (std::wstring::npos != denyEndPos && denyEndPos > denyBeginPos) {
-            _allowList = split(_filterString.substr(0, denyBeginPos), SEPARATOR);
+            allowList = split(_filterString.substr(0, denyBeginPos), SEPARATOR);
             denyBeginPos += DENY_BEGIN.length();
-            _denyList  = split(_filterString.substr(denyBeginPos, denyEndPos - denyBeginPos), SEPARATOR);
+            denyList  = split(_filterString.substr(denyBeginPos, denyEndPos - denyBeginPos), SEPARATOR);
         }
         else {
-            _allowList = split(_filterString.substr(0, denyBeginPos), SEPARATOR);
+            allowList = split(_filterString.substr(0, denyBeginPos), SEPARATOR);
             denyBeginPos += DENY_BEGIN.length();
-            _denyList  = split(_filterString.substr(denyBeginPos), SEPARATOR);
+            denyList  = split(_filterString.substr(denyBeginPos), SEPARATOR);
+        }
+    }
+
+    /*
+     * Rules with a trailing '/' apply to folders only; folder rules in the
+     * allow list are reported as ignored, as allowing never hides a folder.
+     * Deny rules with a '/' hide folders, so that excluded trees are not descended.
+     */
+    auto isFolderRule = [](const std::wstring& pattern) {
+        return pattern.back() == L'/' || pattern.back() == L'\\';
+    };
+    auto normalize = [](std::wstring pattern) {
+        std::replace(pattern.begin(), pattern.end(), L'\\', L'/');
+        while (!pattern.empty() && pattern.back() == L'/') {
+            pattern.pop_back();
+        }
+        return pattern;
+    };
+
+    std::vector<std::wstring> allowFiles;
+    std::vector<std::wstring> denyFiles;
+    std::vector<std::wstring> denyDirectories;
+    _ignoredRules.clear();
+    for (const auto& pattern : allowList) {
+        if (!isFolderRule(pattern)) {
+            allowFiles.push_back(normalize(pattern));
+        }
+        else {
+            _ignoredRules.push_back(pattern);
+        }
+    }
+    for (const auto& pattern : denyList) {
+        const std::wstring normalized = normalize(pattern);
+        if (normalized.empty()) {
+            continue;
+        }
+        if (isFolderRule(pattern)) {
+            denyDirectories.push_back(normalized);
+        }
+        else {
+            denyFiles.push_back(normalized);
+            if (normalized.find(L'/') != std::wstring::npos) {
+                denyDirectories.push_back(normalized);
+            }
         }
     }
 
     // When only the deny list was inputted
-    if (_allowList.empty()) {
-        _allowList.emplace_back(L"*.*");
+    if (allowFiles.empty()) {
+        allowFiles.emplace_back(L"*.*");
     }
+
+    auto rules = std::make_shared<Rules>();
+    rules->isMatchAll = (L"*.*" == _filterString);
+    rules->allow.Compile(allowFiles);
+    rules->deny.Compile(denyFiles);
+    rules->denyDirectories.Compile(denyDirectories);
+    _rules.store(std::move(rules));
+    _generation.fetch_add(1);
 }
 
-LPCWSTR FileFilter::getFilterString()
+LPCWSTR FileFilter::getFilterString() const
 {
     return _filterString.c_str();
 }
 
+const std::vector<std::wstring>& FileFilter::getIgnoredRules() const
+{
+    return _ignoredRules;
+}
 
-BOOL FileFilter::match(const std::wstring &fileName)
+uint64_t FileFilter::getGeneration() const
+{
+    return _generation.load();
+}
+
+
+BOOL FileFilter::match(std::wstring_view directory, std::wstring_view fileName) const
 {
     if (fileName.empty()) {
         return FALSE;
     }
 
-    if (L"*.*" == _filterString) {
+    const std::shared_ptr<const Rules> rules = _rules.load();
+    if (rules->isMatchAll) {
         return TRUE;
     }
 
-    for (const auto &deny : _denyList) {
-        if (0 != wildcmp(deny.c_str(), fileName.c_str())) {
-            return FALSE;
-        }
+    /* names are folded once for all patterns, on the stack when they fit */
+    WCHAR buffer[MAX_PATH];
+    std::wstring longName;
+    std::wstring_view name;
+    if (fileName.size() <= _countof(buffer)) {
+        std::transform(fileName.begin(), fileName.end(), buffer, foldChar);
+        name = std::wstring_view(buffer, fileName.size());
+    }
+    else {
+        longName = foldCase(fileName);
+        name = longName;
     }
 
-    for (const auto& allow : _allowList) {
-        if (0 != wildcmp(allow.c_str(), fileName.c_str())) {
-            return TRUE;
-        }
+    /* the path is only put together for path patterns */
+    std::wstring path;
+    if (!rules->allow.pathGlobs.empty() || !rules->deny.pathGlobs.empty()) {
+        path = foldPath(directory, fileName);
+    }
+
+    if (rules->deny.Match(name, path)) {
+        return FALSE;
+    }
+
+    return rules->allow.Match(name, path) ? TRUE : FALSE;
+}
+
+bool FileFilter::isExcludedDirectory(std::wstring_view parentPath, std::wstring_view name) const
+{
+    const std::shared_ptr<const Rules> rules = _rules.load();
+    if (rules->isMatchAll || name.empty()) {
+        return false;
+    }
+
+    const PatternSet& denied = rules->denyDirectories;
+    if (denied.IsEmpty()) {
+        return false;
     }
 
-    return FALSE;
+    const std::wstring path = foldPath(parentPath, name);
+    return denied.Match(std::wstring_view(path).substr(path.size() - name.size()), path);
 }
@@ -25,20 +25,66 @@
 #pragma once
 
 #include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <vector>
 
+// Patterns are ;-separated, patterns after "[^" hide what they match.
+// A pattern without '/' tests the name, one with '/' the whole path at any
+// depth: '*' and '?' stay within a folder name and "**" spans any number of
+// folders ("src/**/*.cpp", "[^**/generated/**]"). A trailing '/' makes a
+// rule for folders only. Folders are hidden only by deny rules with a '/';
+// folder rules in the allow list are reported by getIgnoredRules().
 class FileFilter
 {
 public:
     FileFilter();
     ~FileFilter();
     void setFilter(std::wstring_view newFilter);
-    LPCWSTR getFilterString();
-    BOOL match(const std::wstring& fileName);
+    LPCWSTR getFilterString() const;
+    const std::vector<std::wstring>& getIgnoredRules() const;
+    // Raised after every setFilter, answers computed from the rules can be stamped with it
+    uint64_t getGeneration() const;
+    BOOL match(std::wstring_view directory, std::wstring_view fileName) const;
+    bool isExcludedDirectory(std::wstring_view parentPath, std::wstring_view name) const;
 private:
-    std::wstring                _filterString;
-    std::vector<std::wstring>   _allowList;
-    std::vector<std::wstring>   _denyList;
+    using Glob = std::vector<std::wstring>;             // literal runs between stars, '?' matches one character
+    using PathGlob = std::vector<std::vector<Glob>>;    // folder name globs between "**"
+
+    // One ;-separated pattern list, compiled for lower case names
+    struct PatternSet {
+        struct Affix {
+            std::wstring prefix;
+            std::wstring suffix;
+            bool hasStar;
+        };
+
+        bool isMatchAll{false};
+        std::vector<std::wstring> extensionNames;
+        std::unordered_set<std::wstring_view> extensions;   // "*.ext", views into extensionNames
+        std::vector<Affix> affixes;                         // at most one '*' and no '?'
+        std::vector<Glob> globs;
+        std::vector<PathGlob> pathGlobs;
+
+        void Compile(const std::vector<std::wstring>& patterns);
+        bool Match(std::wstring_view name, std::wstring_view path) const;
+        bool IsEmpty() const { return !isMatchAll && extensions.empty() && affixes.empty() && globs.empty() && pathGlobs.empty(); }
+    };
+
+    struct Rules {
+        bool isMatchAll{false};
+        PatternSet allow;
+        PatternSet deny;
+        PatternSet denyDirectories;
+    };
+
+    std::wstring                            _filterString;
+    std::vector<std::wstring>               _ignoredRules;
+    std::atomic<uint64_t>                   _generation{0};
+    // Swapped as a whole by setFilter, so matching on other threads never sees a partial filter
+    std::atomic<std::shared_ptr<const Rules>> _rules;
 };
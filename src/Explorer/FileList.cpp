@@ -22,16 +22,22 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "FileFilter.h"
 #include "FileSystemService.h"
 #include "ExplorerModel.h"
+#include "PathTable.h"
 
 #include <windows.h>
 #include <mutex>
 #include <algorithm>
-#include <sstream>
+#include <locale>
 #include <format>
 #include <array>
 #include <cmath>
+#include <climits>
+#include <tuple>
 #include <cwctype>
 #include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include <execution>
 
 #define LVIS_SELANDFOC (LVIS_SELECTED|LVIS_FOCUSED)
 
@@ -53,6 +59,232 @@ namespace SubItem {
     constexpr int Size = 2;
     constexpr int Date = 3;
 }
+
+constexpr std::array<const WCHAR*, 4> SIZE_UNITS{ L"bytes", L"KB", L"MB", L"GB" };
+constexpr std::array<double, 4> POWERS_OF_TEN{ 1.0, 10.0, 100.0, 1000.0 };
+
+/* large enough for any 64-bit size with separators, and for every date format */
+constexpr size_t ROW_TEXT_LENGTH = 64;
+
+/* writes e.g. "1,234 KB" without allocating; digits beyond the precision are cut, not rounded */
+void FormatSize(size_t fileSize, const RowTextFormat& format, std::span<WCHAR> text)
+{
+    auto displayFileSize = static_cast<double>(fileSize);
+    size_t iSizeIndex = 0;
+
+    switch (format.sizeFmt) {
+    case SizeFmt::SFMT_BYTES:
+        iSizeIndex = 0;
+        break;
+    case SizeFmt::SFMT_KBYTE:
+        iSizeIndex = 1;
+        if (fileSize != 0) {
+            displayFileSize += 1023.0;
+            displayFileSize /= 1024.0;
+        }
+        break;
+    default:
+        while ((iSizeIndex < SIZE_UNITS.size() - 1) && (displayFileSize / 1024.0) >= 1) {
+            displayFileSize /= 1024.0;
+            iSizeIndex++;
+        }
+        break;
+    }
+
+    int precision = 0;
+    if (format.sizeFmt == SizeFmt::SFMT_DYNAMIC_EX && iSizeIndex != 0) {
+        if (displayFileSize < 10) {
+            precision = 2;
+        }
+        else if (displayFileSize < 100) {
+            precision = 1;
+        }
+    }
+
+    // If a precision is set, the value is automatically rounded.
+    // Therefore, if the least significant digit to be rounded is greater than 0.5, the value should be less than 0.5.
+    auto least = static_cast<int>((displayFileSize - static_cast<int>(displayFileSize)) * POWERS_OF_TEN[precision + 1]);
+    if (least >= 5) {
+        displayFileSize -= 5.0 / POWERS_OF_TEN[precision + 1];
+    }
+
+    const auto scale = static_cast<uint64_t>(POWERS_OF_TEN[precision]);
+    const auto scaled = static_cast<uint64_t>(displayFileSize * POWERS_OF_TEN[precision] + 0.5);
+    uint64_t integerPart = scaled / scale;
+
+    /* integer digits from right to left, separated as the locale groups them */
+    WCHAR digits[ROW_TEXT_LENGTH];
+    size_t length = 0;
+    size_t groupIndex = 0;
+    int groupDigits = 0;
+    do {
+        const char groupSize = format.grouping.empty() ? 0 : format.grouping[std::min(groupIndex, format.grouping.size() - 1)];
+        if (groupSize > 0 && groupSize != CHAR_MAX && groupDigits == groupSize && format.thousandsSep != L'\0') {
+            digits[length++] = format.thousandsSep;
+            groupDigits = 0;
+            groupIndex++;
+        }
+        digits[length++] = static_cast<WCHAR>(L'0' + integerPart % 10);
+        groupDigits++;
+        integerPart /= 10;
+    } while (integerPart != 0);
+    std::reverse(digits, digits + length);
+
+    if (precision > 0) {
+        swprintf(text.data(), text.size(), L"%.*ls%lc%0*llu %ls", static_cast<int>(length), digits, format.decimalPoint, precision, scaled % scale, SIZE_UNITS[iSizeIndex]);
+    }
+    else {
+        swprintf(text.data(), text.size(), L"%.*ls %ls", static_cast<int>(length), digits, SIZE_UNITS[iSizeIndex]);
+    }
+}
+
+void FormatDate(time_t lastWriteTime, const RowTextFormat& format, std::span<WCHAR> text)
+{
+    struct tm   tm_time;
+
+    if (localtime_s(&tm_time, &lastWriteTime) != 0) {
+        text[0] = L'\0';
+        return;
+    }
+
+    if (format.dateFmt == DateFmt::DFMT_ENG) {
+        swprintf(text.data(), text.size(), L"%02d/%02d/%02d %02d:%02d", (tm_time.tm_year + 1900) % 100, tm_time.tm_mon + 1, tm_time.tm_mday, tm_time.tm_hour, tm_time.tm_min);
+    }
+    else if (format.dateFmt == DateFmt::DFMT_MDY) {
+        swprintf(text.data(), text.size(), L"%02d/%02d/%04d %02d:%02d", tm_time.tm_mon + 1, tm_time.tm_mday, tm_time.tm_year + 1900, tm_time.tm_hour, tm_time.tm_min);
+    }
+    else {
+        swprintf(text.data(), text.size(), L"%02d.%02d.%04d %02d:%02d", tm_time.tm_mday, tm_time.tm_mon + 1, tm_time.tm_year + 1900, tm_time.tm_hour, tm_time.tm_min);
+    }
+}
+
+/* the same folding WM_CHAR applies to the type-ahead query */
+std::wstring FoldName(std::wstring_view name)
+{
+    std::wstring folded(name);
+    std::transform(folded.begin(), folded.end(), folded.begin(), std::towlower);
+    return folded;
+}
+
+bool NameIndexOrder(const NameIndexEntry& lhs, const NameIndexEntry& rhs)
+{
+    return std::tie(lhs.foldedName, lhs.row) < std::tie(rhs.foldedName, rhs.row);
+}
+
+/* below this size the thread start-up costs more than it saves */
+constexpr size_t PARALLEL_SORT_THRESHOLD = 16384;
+
+/* sort key equivalent of StrCmpLogicalW: case-insensitive, digit runs by value */
+std::string MakeCollationKey(std::wstring_view name)
+{
+    constexpr DWORD flags = LCMAP_SORTKEY | NORM_IGNORECASE | SORT_DIGITSASNUMBERS;
+    const int length = static_cast<int>(name.size());
+    const int size = ::LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, name.data(), length, nullptr, 0, nullptr, nullptr, 0);
+    if (size <= 0) {
+        return {};
+    }
+    std::string key(static_cast<size_t>(size), '\0');
+    ::LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, name.data(), length, reinterpret_cast<LPWSTR>(key.data()), size, nullptr, nullptr, 0);
+    return key;
+}
+
+FileSortRecord MakeSortRecord(const std::shared_ptr<ExplorerEntry>& entry, size_t listingIndex)
+{
+    std::wstring_view extension;
+    if (!entry->IsDirectory()) {
+        size_t extPos = entry->Name().find_last_of(L'.');
+        if (extPos != std::wstring_view::npos && extPos > 0) {
+            extension = entry->Name().substr(extPos + 1);
+        }
+    }
+    return { entry, {}, extension, entry->FileSize(), entry->LastWriteTime(), entry->IsParent(), entry->IsDirectory(), listingIndex };
+}
+
+/* a row whose name and these attributes did not change keeps its view cache */
+bool IsSameFile(const ExplorerEntry& lhs, const ExplorerEntry& rhs)
+{
+    return lhs.Attributes() == rhs.Attributes() && lhs.FileSize() == rhs.FileSize() && lhs.LastWriteTime() == rhs.LastWriteTime();
+}
+
+/* fills in the collation keys that are still missing */
+void CollateSortRecords(std::span<FileSortRecord> records)
+{
+    auto makeKey = [](FileSortRecord& record) {
+        if (record.collationKey.empty()) {
+            record.collationKey = MakeCollationKey(record.entry->Name());
+        }
+    };
+    if (records.size() >= PARALLEL_SORT_THRESHOLD) {
+        std::for_each(std::execution::par, records.begin(), records.end(), makeKey);
+    }
+    else {
+        std::for_each(records.begin(), records.end(), makeKey);
+    }
+}
+
+template <typename T>
+int CompareValues(const T& lhs, const T& rhs)
+{
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/* parent first, then folders by name, then files by the sort column */
+class SortRecordOrder {
+public:
+    SortRecordOrder(int sortPos, bool ascending) : _sortPos(sortPos), _ascending(ascending) {}
+
+    bool operator()(const FileSortRecord& lhs, const FileSortRecord& rhs) const {
+        if (lhs.isParent != rhs.isParent) {
+            return lhs.isParent > rhs.isParent;
+        }
+        if (lhs.isDirectory != rhs.isDirectory) {
+            return lhs.isDirectory > rhs.isDirectory;
+        }
+
+        /* std::string compares its chars as unsigned, as a sort key requires.
+           Names the collation treats as equal, e.g. differing only in case or
+           width, are ordered by their raw text and then by listing position,
+           so that every sort gives the same order */
+        int resultNameExt = lhs.collationKey.compare(rhs.collationKey);
+        if (resultNameExt == 0) {
+            resultNameExt = lhs.entry->Name().compare(rhs.entry->Name());
+        }
+        if (resultNameExt == 0) {
+            resultNameExt = CompareValues(lhs.listingIndex, rhs.listingIndex);
+        }
+        if (lhs.isDirectory) {
+            return resultNameExt < 0;
+        }
+
+        int result = 0;
+        switch (_sortPos) {
+        case SubItem::Name:
+            result = resultNameExt;
+            break;
+        case SubItem::Extension:
+            result = lhs.extension.compare(rhs.extension);
+            break;
+        case SubItem::Size:
+            result = CompareValues(lhs.fileSize, rhs.fileSize);
+            break;
+        case SubItem::Date:
+            result = CompareValues(lhs.lastWriteTime, rhs.lastWriteTime);
+            break;
+        default:
+            break;
+        }
+
+        if (result == 0) {
+            result = resultNameExt;
+        }
+
+        return _ascending ? result < 0 : result > 0;
+    }
+
+private:
+    int _sortPos;
+    bool _ascending;
+};
 }
 
 FileList::FileList(ExplorerViewModel *viewModel)
@@ -172,6 +404,9 @@ LRESULT FileList::runListProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lPa
         }
 
         _vFileList.clear();
+        _sortRecords.clear();
+        _nameIndex.clear();
+        _isNameIndexValid = false;
         ::RemoveWindowSubclass(hwnd, wndDefaultListProc, LIST_SUBCLASS_ID);
         break;
     }
@@ -217,18 +452,14 @@ LRESULT FileList::runListProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lPa
     {
         IconResult* result = reinterpret_cast<IconResult*>(lParam);
         if (result) {
-            auto normalizePath = [](std::wstring p) {
-                if (!p.empty() && p.back() == '\\') {
-                    p.pop_back();
-                }
-                return p;
-            };
+            /* icons are only fetched for the listed folder; Find() never grows the table */
             if (result->generation == _currentGeneration &&
-                _wcsicmp(normalizePath(result->workDir).c_str(), normalizePath(_pSettings->GetCurrentDir()).c_str()) == 0) {
+                PathTable::Instance().Find(result->workDir) == _listedDir) {
                 UINT iPos = result->index;
                 if (iPos < _uMaxElements && iPos < _vFileList.size() && _vFileList[iPos]->Name() == result->fileName) {
                     _vFileList[iPos]->SetIcon(result->icon);
                     _vFileList[iPos]->SetOverlay(result->overlay);
+                    _vFileList[iPos]->SetIconFetched(true);
 
                     RECT rcIcon = {0};
                     ListView_GetSubItemRect(_hSelf, iPos, 0, LVIR_ICON, &rcIcon);
@@ -359,6 +590,12 @@ BOOL FileList::notify(WPARAM wParam, LPARAM lParam)
             }
             break;
         }
+        case LVN_ODCACHEHINT: {
+            /* list view is about to show these rows, fetch their icons */
+            const auto* cacheHint = reinterpret_cast<LPNMLVCACHEHINT>(lParam);
+            FetchVisibleIcons(cacheHint->iFrom, cacheHint->iTo);
+            break;
+        }
         case LVN_COLUMNCLICK: {
             /* store the marked items */
             for (UINT i = 0; i < _uMaxElements; i++) {
@@ -380,6 +617,10 @@ BOOL FileList::notify(WPARAM wParam, LPARAM lParam)
             for (UINT i = 0; i < _uMaxElements; i++) {
                 ListView_SetItemState(_hSelf, i, _vFileList[i]->ViewState(), LVIS_FOCUSED | LVIS_SELECTED);
             }
+
+            /* queued icon work refers to the old row order */
+            INT iTop = ListView_GetTopIndex(_hSelf);
+            FetchVisibleIcons(iTop, iTop + ListView_GetCountPerPage(_hSelf));
             break;
         }
         case LVN_KEYDOWN: {
@@ -496,7 +737,7 @@ void FileList::ReadArrayToList(LPTSTR szItem, INT iItem ,INT iSubItem)
     /* copy into temp */
     switch (iSubItem) {
     case SubItem::Name: {
-        std::wstring name = _vFileList[iItem]->Name();
+        std::wstring name(_vFileList[iItem]->Name());
         if (!_vFileList[iItem]->IsDirectory()) {
             size_t extBegPos = name.find_last_of(L'.');
             if (extBegPos != std::wstring::npos && extBegPos > 0 && !_pSettings->IsAddExtToName()) {
@@ -517,7 +758,7 @@ void FileList::ReadArrayToList(LPTSTR szItem, INT iItem ,INT iSubItem)
             szItem[0] = '\0';
         }
         else {
-            std::wstring name = _vFileList[iItem]->Name();
+            std::wstring name(_vFileList[iItem]->Name());
             size_t extBegPos = name.find_last_of(L'.');
             if (extBegPos != std::wstring::npos && extBegPos > 0) {
                 wcscpy(szItem, name.substr(extBegPos + 1).c_str());
@@ -529,21 +770,30 @@ void FileList::ReadArrayToList(LPTSTR szItem, INT iItem ,INT iSubItem)
         break;
     }
     case SubItem::Size: {
-        if (_vFileList[iItem]->IsDirectory()) {
+        FileSortRecord& record = _sortRecords[iItem];
+        if (record.isDirectory) {
             wcscpy(szItem, L"<DIR>");
+            break;
         }
-        else {
-            std::wstring strSize;
-            GetSize(_vFileList[iItem]->FileSize(), strSize);
-            wcscpy(szItem, strSize.c_str());
+        UpdateRowTextFormat();
+        if (record.sizeText.empty()) {
+            WCHAR text[ROW_TEXT_LENGTH];
+            FormatSize(record.fileSize, _rowTextFormat, text);
+            record.sizeText = text;
         }
+        wcscpy(szItem, record.sizeText.c_str());
         break;
     }
     case SubItem::Date:
     default: {
-        std::wstring strDate;
-        GetDate(_vFileList[iItem]->LastWriteTime(), strDate);
-        wcscpy(szItem, strDate.c_str());
+        FileSortRecord& record = _sortRecords[iItem];
+        UpdateRowTextFormat();
+        if (record.dateText.empty()) {
+            WCHAR text[ROW_TEXT_LENGTH];
+            FormatDate(record.lastWriteTime, _rowTextFormat, text);
+            record.dateText = text;
+        }
+        wcscpy(szItem, record.dateText.c_str());
         break;
     }
     }
@@ -561,115 +811,233 @@ void FileList::OnCurrentDirectoryChanged(const std::wstring& path)
     _uMaxElementsOld = _uMaxElements;
     _pendingLoadDir = path;
     _pendingRedraw = TRUE;
+    _isListingStreamed = false;
 }
 
 void FileList::OnDirectoryEntriesLoaded(const std::wstring& currentDir, const std::vector<std::shared_ptr<ExplorerEntry>>& entries)
 {
-    auto normalizePath = [](std::wstring p) {
-        if (!p.empty() && p.back() == '\\') {
-            p.pop_back();
-        }
-        return p;
-    };
-    if (_wcsicmp(normalizePath(currentDir).c_str(), normalizePath(_pendingLoadDir).c_str()) != 0) {
+    PathTable& pathTable = PathTable::Instance();
+    if (pathTable.Intern(currentDir) != pathTable.Intern(_pendingLoadDir)) {
         return;
     }
 
-    std::vector<std::shared_ptr<ExplorerEntry>> vFoldersTemp;
-    std::vector<std::shared_ptr<ExplorerEntry>> vFilesTemp;
-
-    for (const auto& entry : entries) {
-        if (entry->IsDirectory()) {
-            if (_pSettings->IsHideFoldersInFileList()) {
-                continue; // Skip directories if hideFoldersInContentView is true
-            }
+    /* a refresh of the listed folder keeps the rows that did not change */
+    const PathId dirId = pathTable.Intern(currentDir);
+    const bool isRefresh = (dirId == _listedDir && _pendingRedraw == FALSE);
+    std::vector<FileSortRecord> oldRecords = std::move(_sortRecords);
+    std::unordered_map<std::wstring_view, FileSortRecord*> oldRows;
+    if (dirId == _listedDir) {
+        oldRows.reserve(oldRecords.size());
+        for (auto& record : oldRecords) {
+            oldRows.emplace(record.entry->Name(), &record);
+        }
+    }
 
-            if (entry->IsParent()) {
-                if (PathIsRoot(currentDir.c_str())) {
-                    continue;
-                }
-                vFoldersTemp.push_back(entry);
-            }
-            else {
-                /* regular folder */
-                vFoldersTemp.push_back(entry);
-            }
+    /* the names stay valid as long as oldRecords holds the entries */
+    std::unordered_set<std::wstring_view> selectedNames;
+    std::wstring_view focusedName;
+    if (isRefresh) {
+        for (INT iItem = ListView_GetNextItem(_hSelf, -1, LVNI_SELECTED); iItem != -1; iItem = ListView_GetNextItem(_hSelf, iItem, LVNI_SELECTED)) {
+            selectedNames.insert(_vFileList[iItem]->Name());
         }
-        else if (_pSettings->GetFileFilter().match(entry->Name().c_str())) {
-            /* file */
-            vFilesTemp.push_back(entry);
+        INT iFocused = ListView_GetNextItem(_hSelf, -1, LVNI_FOCUSED);
+        if (iFocused != -1) {
+            focusedName = _vFileList[iFocused]->Name();
         }
     }
 
-    /* delete old global list */
     _vFileList.clear();
+    _sortRecords.clear();
+    _uMaxFolders = 0;
+    for (const auto& entry : entries) {
+        if (!IsShownInList(*entry, currentDir)) {
+            continue;
+        }
+        _vFileList.push_back(entry);
+        _sortRecords.push_back(MakeSortRecord(entry, _sortRecords.size()));
+        if (entry->IsDirectory()) {
+            _uMaxFolders++;
+        }
 
-    /* set temporal list as global */
-    for (const auto& folder : vFoldersTemp) {
-        folder->ResetViewCache();
-        _vFileList.push_back(folder);
-    }
-    for (const auto &file : vFilesTemp) {
-        file->ResetViewCache();
-        _vFileList.push_back(file);
+        /* unchanged rows keep icon, overlay, view state and collation key */
+        auto oldRow = oldRows.find(entry->Name());
+        if (oldRow != oldRows.end() && IsSameFile(*oldRow->second->entry, *entry)) {
+            entry->CopyViewCache(*oldRow->second->entry);
+            _sortRecords.back().collationKey = std::move(oldRow->second->collationKey);
+            _sortRecords.back().sizeText = std::move(oldRow->second->sizeText);
+            _sortRecords.back().dateText = std::move(oldRow->second->dateText);
+        }
+        else {
+            entry->ResetViewCache();
+        }
     }
-
-    /* set max elements in list */
-    _uMaxFolders    = vFoldersTemp.size();
-    _uMaxElements   = _uMaxFolders + vFilesTemp.size();
-    vFoldersTemp.clear();
-    vFilesTemp.clear();
+    _uMaxElements = _vFileList.size();
+    CollateSortRecords(_sortRecords);
 
     /* update list content */
     UpdateList();
 
-    /* select first entry or the pending file */
-    if (_pendingRedraw == TRUE) {
-        bool selected = false;
-        if (!_pendingSelectFile.empty()) {
-            for (SIZE_T i = _uMaxFolders; i < _uMaxElements; i++) {
-                if (_pendingSelectFile == _vFileList[i]->Name()) {
-                     SetFocusItem(i);
-                     selected = true;
-                     break;
+    if (isRefresh) {
+        /* carry the selection over by name */
+        ListView_SetItemState(_hSelf, -1, 0, LVIS_SELANDFOC);
+        if (!selectedNames.empty() || !focusedName.empty()) {
+            for (SIZE_T i = 0; i < _uMaxElements; i++) {
+                const std::wstring_view name = _vFileList[i]->Name();
+                UINT state = (selectedNames.contains(name) ? LVIS_SELECTED : 0) | (name == focusedName ? LVIS_FOCUSED : 0);
+                if (state != 0) {
+                    ListView_SetItemState(_hSelf, i, state, state);
                 }
             }
-            _pendingSelectFile.clear();
         }
-        if (!selected) {
-            SetFocusItem(0);
+    }
+    else {
+        /* select first entry or the pending file */
+        if (_pendingRedraw == TRUE) {
+            bool selected = false;
+            if (!_pendingSelectFile.empty()) {
+                INT iItem = FindItemByName(_pendingSelectFile, false);
+                if (iItem != -1) {
+                    SetFocusItem(iItem);
+                    selected = true;
+                }
+                _pendingSelectFile.clear();
+            }
+            /* a streamed listing got its focus with the first chunk */
+            if (!selected && !_isListingStreamed) {
+                SetFocusItem(0);
+            }
+            _pendingRedraw = FALSE;
+        }
+
+        // Restore previous selection
+        auto prevSel = _viewModel->GetCurrentSelection();
+        if (!prevSel.empty()) {
+            ListView_SetItemState(_hSelf, -1, 0, 0xFF);
+            for (const auto& name : prevSel) {
+                /* a folder and a file cannot share a name */
+                INT iItem = FindItemByName(name, true);
+                if (iItem == -1) {
+                    iItem = FindItemByName(name, false);
+                }
+                if (iItem != -1) {
+                    ListView_SetItemState(_hSelf, iItem, LVIS_SELECTED | LVIS_FOCUSED, 0xFF);
+                }
+            }
         }
-        _pendingRedraw = FALSE;
     }
 
-    // Restore previous selection
-    auto prevSel = _viewModel->GetCurrentSelection();
-    if (!prevSel.empty()) {
-        for (UINT iItem = 0; iItem < _uMaxElements; iItem++) {
-            ListView_SetItemState(_hSelf, iItem, 0, 0xFF);
+    _listedDir = dirId;
+    _isListingStreamed = false;
+
+    /* further rows get their icons when they are scrolled into view */
+    INT iTop = ListView_GetTopIndex(_hSelf);
+    FetchVisibleIcons(iTop, iTop + ListView_GetCountPerPage(_hSelf));
+}
+
+void FileList::OnDirectoryEntriesAppended(const std::wstring& currentDir, const std::vector<std::shared_ptr<ExplorerEntry>>& entries)
+{
+    PathTable& pathTable = PathTable::Instance();
+    if (pathTable.Intern(currentDir) != pathTable.Intern(_pendingLoadDir)) {
+        return;
+    }
+
+    /* the first chunk replaces the list of the previous folder */
+    const bool isFirstChunk = !_isListingStreamed;
+    if (isFirstChunk) {
+        _vFileList.clear();
+        _sortRecords.clear();
+        _uMaxFolders = 0;
+        _isListingStreamed = true;
+        _listedDir = pathTable.Intern(currentDir);
+    }
+
+    /* merging shifts the rows, so remember the selection by entry */
+    std::unordered_set<const ExplorerEntry*> selection;
+    const ExplorerEntry* focused = nullptr;
+    if (!isFirstChunk) {
+        for (INT iItem = ListView_GetNextItem(_hSelf, -1, LVNI_SELECTED); iItem != -1; iItem = ListView_GetNextItem(_hSelf, iItem, LVNI_SELECTED)) {
+            selection.insert(_vFileList[iItem].get());
         }
-        for (const auto& name : prevSel) {
-            for (SIZE_T i = 0; i < _uMaxElements; i++) {
-                if (_vFileList[i]->Name() == name) {
-                    ListView_SetItemState(_hSelf, i, LVIS_SELECTED | LVIS_FOCUSED, 0xFF);
-                }
+        INT iFocused = ListView_GetNextItem(_hSelf, -1, LVNI_FOCUSED);
+        if (iFocused != -1) {
+            focused = _vFileList[iFocused].get();
+        }
+    }
+
+    const SIZE_T uOldElements = _vFileList.size();
+    for (const auto& entry : entries) {
+        if (IsShownInList(*entry, currentDir)) {
+            entry->ResetViewCache();
+            _vFileList.push_back(entry);
+            _sortRecords.push_back(MakeSortRecord(entry, _sortRecords.size()));
+            if (entry->IsDirectory()) {
+                _uMaxFolders++;
             }
         }
     }
+    if (!isFirstChunk && _vFileList.size() == uOldElements) {
+        return;
+    }
 
-    std::vector<IconWorkItem> workItems;
-    for (UINT i = 0; i < _uMaxElements; ++i) {
-        if (_vFileList[i]->IsParent()) {
-            continue;
+    /* both parts are sorted, so a merge keeps the order stable as chunks arrive */
+    CollateSortRecords(std::span(_sortRecords).subspan(uOldElements));
+    const SortRecordOrder order(_pSettings->GetSortPos(), _pSettings->IsAscending());
+    std::sort(_sortRecords.begin() + uOldElements, _sortRecords.end(), order);
+    std::inplace_merge(_sortRecords.begin(), _sortRecords.begin() + uOldElements, _sortRecords.end(), order);
+    ApplySortOrder();
+
+    _uMaxElements = _vFileList.size();
+    ListView_SetItemCountEx(_hSelf, _uMaxElements, LVSICF_NOSCROLL);
+    _uMaxElementsOld = _uMaxElements;
+
+    if (isFirstChunk) {
+        SetFocusItem(0);
+    }
+    else if (!selection.empty() || focused != nullptr) {
+        ListView_SetItemState(_hSelf, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+        for (SIZE_T i = 0; i < _uMaxElements; i++) {
+            const ExplorerEntry* entry = _vFileList[i].get();
+            UINT state = (selection.contains(entry) ? LVIS_SELECTED : 0) | (entry == focused ? LVIS_FOCUSED : 0);
+            if (state != 0) {
+                ListView_SetItemState(_hSelf, i, state, state);
+            }
         }
-        IconWorkItem item;
-        item.index = i;
-        item.name = _vFileList[i]->Name();
-        item.type = (i < _uMaxFolders ? DEVT_DIRECTORY : DEVT_FILE);
-        workItems.push_back(item);
+    }
+}
+
+void FileList::FetchVisibleIcons(INT iFirst, INT iLast)
+{
+    const INT iMax = static_cast<INT>(_uMaxElements) - 1;
+    if (iLast < iFirst || iMax < 0) {
+        return;
     }
 
-    _viewModel->FetchFileListIcons(this, _hSelf, currentDir, std::move(workItems), _cancelToken, _currentGeneration);
+    /* the rows on screen, then a page below and a page above, then one more
+       page on each side that is only fetched while the worker has nothing else */
+    const INT page = iLast - iFirst + 1;
+    std::vector<IconWorkItem> workItems;
+    auto addRows = [&](INT from, INT to) {
+        for (INT i = std::max(from, 0); i <= std::min(to, iMax); i++) {
+            const auto& entry = _vFileList[i];
+            if (entry->IsParent() || entry->IsIconFetched()) {
+                continue;
+            }
+            IconWorkItem item;
+            item.index = static_cast<UINT>(i);
+            item.name = entry->Name();
+            item.type = (static_cast<SIZE_T>(i) < _uMaxFolders ? DEVT_DIRECTORY : DEVT_FILE);
+            workItems.push_back(item);
+        }
+    };
+    addRows(iFirst, iLast);
+    addRows(iLast + 1, iLast + page);
+    addRows(iFirst - page, iFirst - 1);
+    addRows(iLast + page + 1, iLast + 2 * page);
+    addRows(iFirst - 2 * page, iFirst - page - 1);
+
+    /* replaces the work queued for the previous viewport */
+    _viewModel->FetchFileListIcons(this, _hSelf, _pSettings->GetCurrentDir(), std::move(workItems), _cancelToken, _currentGeneration);
+    _viewModel->PrioritizeFileListRows(iFirst, iLast);
 }
 
 void FileList::filterFiles(LPCTSTR currentFilter)
@@ -679,11 +1047,12 @@ void FileList::filterFiles(LPCTSTR currentFilter)
 
 void FileList::SelectFolder(LPCTSTR filePath)
 {
-    for (UINT uFolder = 0; uFolder < _uMaxFolders; uFolder++) {
-        if (_wcsicmp(_vFileList[uFolder]->Name().c_str(), filePath) == 0) {
-            SetFocusItem(uFolder);
-            return;
-        }
+    /* folder names are matched case-insensitive */
+    UpdateNameIndex();
+    const std::wstring foldedName = FoldName(filePath);
+    auto match = std::lower_bound(_nameIndex.begin(), _nameIndex.end(), NameIndexEntry{ foldedName, 0 }, NameIndexOrder);
+    if (match != _nameIndex.end() && match->foldedName == foldedName && match->row < _uMaxFolders) {
+        SetFocusItem(match->row);
     }
 }
 
@@ -703,67 +1072,45 @@ void FileList::SelectFile(const std::wstring &fileName)
         return;
     }
 
-    for (SIZE_T i = _uMaxFolders; i < _uMaxElements; i++) {
-        if (fileName == _vFileList[i]->Name()) {
-            SetFocusItem(i);
-            return;
-        }
+    INT iItem = FindItemByName(fileName, false);
+    if (iItem != -1) {
+        SetFocusItem(iItem);
     }
 }
 
-void FileList::UpdateList()
+bool FileList::IsShownInList(const ExplorerEntry& entry, const std::wstring& currentDir) const
 {
-    std::sort(_vFileList.begin(), _vFileList.end(), [&](const std::shared_ptr<ExplorerEntry>& lhs, const std::shared_ptr<ExplorerEntry>& rhs) {
-        if (lhs->IsParent() != rhs->IsParent()) {
-            return lhs->IsParent() > rhs->IsParent();
-        }
-        if (lhs->IsDirectory() != rhs->IsDirectory()) {
-            return lhs->IsDirectory() > rhs->IsDirectory();
+    if (entry.IsDirectory()) {
+        if (_pSettings->IsHideFoldersInFileList()) {
+            return false; // Skip directories if hideFoldersInContentView is true
         }
-
-        const int resultNameExt = ::StrCmpLogicalW(lhs->Name().c_str(), rhs->Name().c_str());
-        INT64 result = 0;
-
-        if (lhs->IsDirectory() && rhs->IsDirectory()) {
-            return resultNameExt < 0;
-        }
-
-        switch (_pSettings->GetSortPos()) {
-        case SubItem::Name:
-            result = resultNameExt;
-            break;
-        case SubItem::Extension: {
-            std::wstring lhsExt, rhsExt;
-            size_t lhsExtPos = lhs->Name().find_last_of(L'.');
-            if (lhsExtPos != std::wstring::npos && lhsExtPos > 0) lhsExt = lhs->Name().substr(lhsExtPos + 1);
-            size_t rhsExtPos = rhs->Name().find_last_of(L'.');
-            if (rhsExtPos != std::wstring::npos && rhsExtPos > 0) rhsExt = rhs->Name().substr(rhsExtPos + 1);
-            result = lhsExt.compare(rhsExt);
-            break;
-        }
-        case SubItem::Size:
-            result = static_cast<INT64>(lhs->FileSize()) - static_cast<INT64>(rhs->FileSize());
-            break;
-        case SubItem::Date: {
-            time_t lhsDate = lhs->LastWriteTime();
-            time_t rhsDate = rhs->LastWriteTime();
-            result = static_cast<INT64>(lhsDate - rhsDate);
-            break;
-        }
-        default:
-            break;
-        }
-
-        if (result == 0) {
-            result = resultNameExt;
+        if (entry.IsParent()) {
+            return !PathIsRoot(currentDir.c_str());
         }
+        return !_pSettings->GetFileFilter().isExcludedDirectory(currentDir, entry.Name());
+    }
+    return _pSettings->GetFileFilter().match(currentDir, entry.Name());
+}
 
-        if (!_pSettings->IsAscending()) {
-            result *= -1;
-        }
+void FileList::ApplySortOrder()
+{
+    for (size_t i = 0; i < _sortRecords.size(); i++) {
+        _vFileList[i] = _sortRecords[i].entry;
+    }
+    _isNameIndexValid = false;
+}
 
-        return result < 0;
-    });
+void FileList::UpdateList()
+{
+    /* the keys are kept, a column click only re-sorts */
+    const SortRecordOrder order(_pSettings->GetSortPos(), _pSettings->IsAscending());
+    if (_sortRecords.size() >= PARALLEL_SORT_THRESHOLD) {
+        std::sort(std::execution::par, _sortRecords.begin(), _sortRecords.end(), order);
+    }
+    else {
+        std::sort(_sortRecords.begin(), _sortRecords.end(), order);
+    }
+    ApplySortOrder();
 
     /* avoid flickering */
     if (_uMaxElementsOld != _uMaxElements) {
@@ -888,7 +1235,7 @@ void FileList::ShowContextMenu(std::optional<POINT> screenLocation)
 
     if (entries.empty()) {
         FileSystemEntry currentDirFsEntry(_pSettings->GetCurrentDir(), FILE_ATTRIBUTE_DIRECTORY, 0, 0, false);
-        entries.push_back(std::make_shared<ExplorerEntry>(_pSettings->GetCurrentDir(), currentDirFsEntry));
+        entries.push_back(ExplorerEntry::Create(_pSettings->GetCurrentDir(), currentDirFsEntry));
     }
 
     const auto hasStandardMenu = (!isParent || (entries.size() != 1));
@@ -919,33 +1266,24 @@ void FileList::onSelectItem(WCHAR charkey)
     ::KillTimer(_hSelf, EXT_SEARCHFILE);
     ::SetTimer(_hSelf, EXT_SEARCHFILE, 1000, NULL);
 
-    /* initilize again if error previous occured */
-    if (selRow < 0) {
-        selRow = 0;
-    }
-
     /* on first call start searching on next element */
-    if (_searchQuery.empty()) {
-        selRow++;
-    }
+    const bool isFirstChar = _searchQuery.empty();
 
     /* add character to string */
     _searchQuery.append(1, charkey);
 
-    BOOL found = FindNextItemInList(&selRow);
+    BOOL found = FindNextItemInList(&selRow, isFirstChar);
     if (!found) {
         _searchQuery.pop_back();
         if (!_searchQuery.empty()) {
-            selRow++;
-            found = FindNextItemInList(&selRow);
+            found = FindNextItemInList(&selRow, true);
         }
     }
 
     if (found) {
         /* select only one item */
-        for (UINT i = 0; i < _uMaxElements; i++) {
-            ListView_SetItemState(_hSelf, i, (selRow == i ? LVIS_SELANDFOC : 0), 0xFF);
-        }
+        ListView_SetItemState(_hSelf, -1, 0, 0xFF);
+        ListView_SetItemState(_hSelf, selRow, LVIS_SELANDFOC, 0xFF);
         ListView_SetSelectionMark(_hSelf, selRow);
         ListView_EnsureVisible(_hSelf, selRow, TRUE);
     }
@@ -1035,115 +1373,88 @@ void FileList::onDelete(bool immediate)
     }
 }
 
-BOOL FileList::FindNextItemInList(LPUINT puPos)
+BOOL FileList::FindNextItemInList(LPUINT puPos, bool skipCurrent)
 {
-    BOOL bRet       = FALSE;
-    UINT iStartPos  = *puPos;
-
-    /* search in list */
-    for (UINT i = iStartPos; i != (iStartPos-1); i++) {
-        /* if max data is reached, set iterator to zero */
-        if (i == _vFileList.size()) {
-            if (iStartPos <= 1) {
-                break;
-            }
-            i = 0;
-        }
-
-        std::wstring lowerFileName = _vFileList[i]->Name();
-        std::transform(lowerFileName.begin(), lowerFileName.end(), lowerFileName.begin(), towlower);
-        if (0 == lowerFileName.compare(0, _searchQuery.size(), _searchQuery)) {
-            /* string found in any following case */
-            bRet    = TRUE;
-            *puPos  = i;
-            break;
-        }
-    }
-
-    return bRet;
-}
+    UpdateNameIndex();
 
-
-void FileList::GetSize(size_t fileSize, std::wstring & str)
-{
-    constexpr std::array<const WCHAR*, 4> SIZE_UNITS{ L"bytes", L"KB", L"MB", L"GB"};
-
-    auto displayFileSize = static_cast<double>(fileSize);
-    size_t iSizeIndex = 0;
-
-    switch (_pSettings->GetFmtSize()) {
-    case SizeFmt::SFMT_BYTES:
-        iSizeIndex = 0;
-        break;
-    case SizeFmt::SFMT_KBYTE:
-        iSizeIndex = 1;
-        if (fileSize != 0) {
-            displayFileSize += 1023.0;
-            displayFileSize /= 1024.0;
-        }
-        break;
-    default:
-        while ((iSizeIndex < SIZE_UNITS.size() - 1) && (displayFileSize / 1024.0) >= 1) {
-            displayFileSize /= 1024.0;
-            iSizeIndex++;
-        }
-        break;
+    /* the names starting with the query are one range of the index */
+    auto first = std::lower_bound(_nameIndex.begin(), _nameIndex.end(), NameIndexEntry{ _searchQuery, 0 }, NameIndexOrder);
+    auto last = std::partition_point(first, _nameIndex.end(), [this](const NameIndexEntry& entry) {
+        return entry.foldedName.starts_with(_searchQuery);
+    });
+    if (first == last) {
+        return FALSE;
     }
 
-    int precision = 0;
-    if (_pSettings->GetFmtSize() == SizeFmt::SFMT_DYNAMIC_EX) {
-        if (iSizeIndex == 0) {
-            precision = 0;
+    /* take the next row at (or after) the start position, else wrap to the top */
+    const UINT iStartPos = *puPos;
+    UINT iNext = UINT_MAX;
+    UINT iWrapped = UINT_MAX;
+    for (auto it = first; it != last; ++it) {
+        if (skipCurrent ? (it->row > iStartPos) : (it->row >= iStartPos)) {
+            iNext = std::min(iNext, it->row);
         }
         else {
-            if (displayFileSize < 10) {
-                precision = 2;
-            }
-            else if (displayFileSize < 100) {
-                precision = 1;
-            }
-            else {
-                precision = 0;
-            }
+            iWrapped = std::min(iWrapped, it->row);
         }
     }
-
-    // If a precision is set, the value is automatically rounded.
-    // Therefore, if the least significant digit to be rounded is greater than 0.5, the value should be less than 0.5.
-    auto least = static_cast<int>((displayFileSize - static_cast<int>(displayFileSize)) * std::pow(10.0, precision + 1));
-    if (least >= 5) {
-        displayFileSize -= 5.0 * std::pow(10.0, -(precision + 1));
-    }
-
-    std::wstringstream ss;
-    ss.imbue(std::locale(""));
-    ss.precision(precision);
-    ss << std::fixed << displayFileSize << L" " << SIZE_UNITS.at(iSizeIndex);
-
-    str = ss.str();
+    *puPos = (iNext != UINT_MAX) ? iNext : iWrapped;
+    return TRUE;
 }
 
-void FileList::GetDate(time_t lastWriteTime, std::wstring & str)
+/* rebuilt on the first lookup after the rows changed */
+void FileList::UpdateNameIndex()
 {
-    struct tm   tm_time;
-    WCHAR       TEMP[32];
-
-    if (localtime_s(&tm_time, &lastWriteTime) != 0) {
-        str = L"";
+    if (_isNameIndexValid) {
         return;
     }
+    _nameIndex.clear();
+    _nameIndex.reserve(_vFileList.size());
+    for (UINT i = 0; i < _vFileList.size(); i++) {
+        _nameIndex.push_back({ FoldName(_vFileList[i]->Name()), i });
+    }
+    std::sort(_nameIndex.begin(), _nameIndex.end(), NameIndexOrder);
+    _isNameIndexValid = true;
+}
 
-    if (_pSettings->GetFmtDate() == DateFmt::DFMT_ENG) {
-        swprintf(TEMP, L"%02d/%02d/%02d %02d:%02d", (tm_time.tm_year + 1900) % 100, tm_time.tm_mon + 1, tm_time.tm_mday, tm_time.tm_hour, tm_time.tm_min);
+/* exact name lookup among the folders or among the files, -1 if not listed */
+INT FileList::FindItemByName(std::wstring_view name, bool isDirectory)
+{
+    UpdateNameIndex();
+    const std::wstring foldedName = FoldName(name);
+    for (auto it = std::lower_bound(_nameIndex.begin(), _nameIndex.end(), NameIndexEntry{ foldedName, 0 }, NameIndexOrder);
+         it != _nameIndex.end() && it->foldedName == foldedName; ++it) {
+        if ((it->row < _uMaxFolders) == isDirectory && _vFileList[it->row]->Name() == name) {
+            return static_cast<INT>(it->row);
+        }
     }
-    else if (_pSettings->GetFmtDate() == DateFmt::DFMT_MDY) {
-        swprintf(TEMP, L"%02d/%02d/%04d %02d:%02d", tm_time.tm_mon + 1, tm_time.tm_mday, tm_time.tm_year + 1900, tm_time.tm_hour, tm_time.tm_min);
+    return -1;
+}
+
+
+/* texts of the rows stay valid until the size or date format changes */
+void FileList::UpdateRowTextFormat()
+{
+    const SizeFmt sizeFmt = _pSettings->GetFmtSize();
+    const DateFmt dateFmt = _pSettings->GetFmtDate();
+
+    if (sizeFmt != _rowTextFormat.sizeFmt) {
+        /* the locale is read here instead of per row, std::locale("") is costly to build */
+        const auto& punctuation = std::use_facet<std::numpunct<wchar_t>>(std::locale(""));
+        _rowTextFormat.sizeFmt = sizeFmt;
+        _rowTextFormat.decimalPoint = punctuation.decimal_point();
+        _rowTextFormat.thousandsSep = punctuation.thousands_sep();
+        _rowTextFormat.grouping = punctuation.grouping();
+        for (auto& record : _sortRecords) {
+            record.sizeText.clear();
+        }
     }
-    else {
-        swprintf(TEMP, L"%02d.%02d.%04d %02d:%02d", tm_time.tm_mday, tm_time.tm_mon + 1, tm_time.tm_year + 1900, tm_time.tm_hour, tm_time.tm_min);
+    if (dateFmt != _rowTextFormat.dateFmt) {
+        _rowTextFormat.dateFmt = dateFmt;
+        for (auto& record : _sortRecords) {
+            record.dateText.clear();
+        }
     }
-
-    str = TEMP;
 }
 
 // setDefaultOnCharHandler removed in favor of KeyPreviewCallback
@@ -1158,7 +1469,7 @@ void FileList::UpdateSelItems()
     std::vector<std::wstring> selected;
     for (UINT i = 0; i < _uMaxElements; i++) {
         if (ListView_GetItemState(_hSelf, i, LVIS_SELECTED) == LVIS_SELECTED) {
-            selected.push_back(_vFileList[i]->Name());
+            selected.emplace_back(_vFileList[i]->Name());
         }
     }
     _viewModel->UpdateSelection(selected);
@@ -1166,36 +1477,30 @@ void FileList::UpdateSelItems()
 
 void FileList::SetItems(const std::vector<std::wstring>& vStrItems)
 {
-    std::vector<std::wstring> itemsCopy = vStrItems;
-    UINT selType = LVIS_SELANDFOC;
-
-    for (UINT i = 0; i < _uMaxElements; i++) {
-        bool match = false;
-        for (UINT itemPos = 0; itemPos < itemsCopy.size(); itemPos++) {
-            if (_vFileList[i]->Name() == itemsCopy[itemPos]) {
-                ListView_SetItemState(_hSelf, i, selType, 0xFF);
-
-                /* set first item in view */
-                if (selType == LVIS_SELANDFOC) {
-                    ListView_EnsureVisible(_hSelf, _uMaxElements - 1, FALSE);
-                    ListView_EnsureVisible(_hSelf, i, FALSE);
-                }
-
-                /* delete last found item to be faster in compare */
-                itemsCopy.erase(itemsCopy.begin() + itemPos);
-
-                match = true;
-                selType = LVIS_SELECTED;
-                break;
-            }
+    std::vector<INT> rows;
+    rows.reserve(vStrItems.size());
+    for (const auto& name : vStrItems) {
+        INT iItem = FindItemByName(name, true);
+        if (iItem == -1) {
+            iItem = FindItemByName(name, false);
         }
-        if (!match) {
-            ListView_SetItemState(_hSelf, i, 0, 0xFF);
-        }
-        if (itemsCopy.empty()) {
-            return;
+        if (iItem != -1) {
+            rows.push_back(iItem);
         }
     }
+    std::sort(rows.begin(), rows.end());
+
+    ListView_SetItemState(_hSelf, -1, 0, 0xFF);
+    for (INT iItem : rows) {
+        ListView_SetItemState(_hSelf, iItem, LVIS_SELECTED, 0xFF);
+    }
+
+    /* the topmost item gets the focus and is set in view */
+    if (!rows.empty()) {
+        ListView_SetItemState(_hSelf, rows.front(), LVIS_SELANDFOC, 0xFF);
+        ListView_EnsureVisible(_hSelf, _uMaxElements - 1, FALSE);
+        ListView_EnsureVisible(_hSelf, rows.front(), FALSE);
+    }
 }
 
 
@@ -1323,7 +1628,7 @@ bool FileList::OnDrop(FORMATETC* /* pFmtEtc*/, STGMEDIUM& medium, DWORD* pdwEffe
             ::PathRemoveFileSpec(pszFilesTo);
         }
         else {
-            ::PathAppend(pszFilesTo, _vFileList[hittest.iItem]->Name().c_str());
+            ::PathAppend(pszFilesTo, _vFileList[hittest.iItem]->Name().data());
         }
     }
 
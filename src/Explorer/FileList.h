@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <mutex>
 #include <atomic>
 #include <filesystem>
+#include <span>
 
 
 struct StaInfo {
@@ -56,6 +57,35 @@ struct IconWorkItem {
     DevType type;
 };
 
+/* sort data of a list row, computed once per listing */
+struct FileSortRecord {
+    std::shared_ptr<ExplorerEntry> entry;
+    std::string collationKey;       /* LCMapStringEx sort key, compared bytewise */
+    std::wstring_view extension;
+    size_t fileSize;
+    time_t lastWriteTime;
+    bool isParent;
+    bool isDirectory;
+    size_t listingIndex;            /* position in the listing, the last tiebreak */
+    std::wstring sizeText;          /* formatted on first paint, see RowTextFormat */
+    std::wstring dateText;
+};
+
+/* lower case name of a list row, kept sorted for prefix and exact lookup */
+struct NameIndexEntry {
+    std::wstring foldedName;
+    UINT row;
+};
+
+/* settings and locale punctuation the cached row texts were formatted with */
+struct RowTextFormat {
+    SizeFmt sizeFmt;
+    DateFmt dateFmt;
+    WCHAR decimalPoint;
+    WCHAR thousandsSep;
+    std::string grouping;
+};
+
 struct IconResult {
     std::wstring workDir;
     UINT index;
@@ -80,6 +110,7 @@ public:
     // IExplorerViewModelObserver implementation
     void OnCurrentDirectoryChanged(const std::wstring& path) override;
     void OnDirectoryEntriesLoaded(const std::wstring& path, const std::vector<std::shared_ptr<ExplorerEntry>>& entries) override;
+    void OnDirectoryEntriesAppended(const std::wstring& path, const std::vector<std::shared_ptr<ExplorerEntry>>& entries) override;
     void OnNavigationStateChanged() override {};
     void OnCommandExecutionFailed(const std::wstring& command) override {}
     void OnToggleWorkspaceModeRequested() override {}
@@ -134,10 +165,15 @@ protected:
     void ReadArrayToList(LPTSTR szItem, INT iItem ,INT iSubItem);
 
     void UpdateList();
+    bool IsShownInList(const ExplorerEntry& entry, const std::wstring& currentDir) const;
+    void ApplySortOrder();
+    void FetchVisibleIcons(INT iFirst, INT iLast);
     void SetColumns();
     void SetOrder();
 
-    BOOL FindNextItemInList(LPUINT puPos);
+    BOOL FindNextItemInList(LPUINT puPos, bool skipCurrent);
+    void UpdateNameIndex();
+    INT FindItemByName(std::wstring_view name, bool isDirectory);
 
     void onLMouseBtnDbl();
 
@@ -164,8 +200,7 @@ protected:
         ListView_SetSelectionMark(_hSelf, item);
     };
 
-    void GetSize(size_t size, std::wstring & str);
-    void GetDate(time_t lastWriteTime, std::wstring & str);
+    void UpdateRowTextFormat();
 
 private:    /* for thread */
 
@@ -186,6 +221,10 @@ private:    /* for thread */
     SIZE_T                          _uMaxElements;
     SIZE_T                          _uMaxElementsOld;
     std::vector<std::shared_ptr<ExplorerEntry>> _vFileList;
+    std::vector<FileSortRecord>     _sortRecords;
+    std::vector<NameIndexEntry>     _nameIndex;
+    bool                            _isNameIndexValid{false};
+    RowTextFormat                   _rowTextFormat{ SizeFmt::SFMT_MAX, DateFmt::DFMT_MAX, L'.', L',', {} };
 
     /* search in list by typing of characters */
     std::wstring                    _searchQuery;
@@ -203,5 +242,7 @@ private:    /* for thread */
     KeyPreviewCallback              _keyPreviewCallback;
     std::wstring                    _pendingLoadDir;
     BOOL                            _pendingRedraw;
+    bool                            _isListingStreamed{false};
+    PathId                          _listedDir{INVALID_PATH_ID};
     std::wstring                    _pendingSelectFile;
 };
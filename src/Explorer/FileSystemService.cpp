@@ -1,4 +1,5 @@
 #include "FileSystemService.h"
+#include "FileFilter.h"
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <shlobj.h>
@@ -24,9 +25,9 @@ private:
 
 FileSystemEntry::FileSystemEntry(const std::wstring& name, unsigned int attributes, size_t fileSize, time_t lastWriteTime, bool isParent)
     : _name(name)
-    , _attributes(attributes)
     , _fileSize(fileSize)
     , _lastWriteTime(lastWriteTime)
+    , _attributes(attributes)
     , _isParent(isParent)
 {
 }
@@ -112,7 +113,7 @@ std::wstring FileSystemService::GetRemotePath(const std::wstring& drivePath)
     return {};
 }
 
-bool FileSystemService::HaveChildren(const std::wstring& folderPath, bool useFullTree, bool showHidden)
+bool FileSystemService::HaveChildren(const std::wstring& folderPath, bool useFullTree, bool showHidden, const FileFilter& filter)
 {
     ThreadErrorModeGuard guard;
     std::wstring searchPath = folderPath;
@@ -138,7 +139,7 @@ bool FileSystemService::HaveChildren(const std::wstring& folderPath, bool useFul
             continue;
         }
 
-        if (isDirectory || useFullTree) {
+        if (isDirectory ? !filter.isExcludedDirectory(folderPath, findData.cFileName) : (useFullTree && filter.match(folderPath, findData.cFileName))) {
             hasChildren = true;
             break;
         }
@@ -150,43 +151,79 @@ bool FileSystemService::HaveChildren(const std::wstring& folderPath, bool useFul
 
 std::vector<FileSystemEntry> FileSystemService::GetDirectoryEntries(const std::wstring& path, bool showHidden, bool includeParent)
 {
-    ThreadErrorModeGuard guard;
     std::vector<FileSystemEntry> entries;
-    std::wstring findPath = path;
-    if (findPath.empty()) return entries;
-    if (findPath.back() != L'\\') {
-        findPath.push_back(L'\\');
+    DirectoryEnumerator enumerator(path, showHidden, includeParent);
+    enumerator.Read(entries, SIZE_MAX);
+    return entries;
+}
+
+struct DirectoryEnumerator::State {
+    std::wstring findPath;
+    bool showHidden;
+    bool includeParent;
+    HANDLE hFind = nullptr;     // nullptr until the first Read()
+    bool atEnd = false;
+    WIN32_FIND_DATA findData{}; // next entry to hand out unless atEnd
+};
+
+DirectoryEnumerator::DirectoryEnumerator(const std::wstring& path, bool showHidden, bool includeParent)
+    : _state(std::make_unique<State>())
+{
+    _state->showHidden = showHidden;
+    _state->includeParent = includeParent;
+    if (path.empty()) {
+        _state->atEnd = true;
+        return;
+    }
+    _state->findPath = path;
+    if (_state->findPath.back() != L'\\') {
+        _state->findPath.push_back(L'\\');
     }
-    findPath.push_back(L'*');
+    _state->findPath.push_back(L'*');
+}
 
-    WIN32_FIND_DATA findData{};
-    HANDLE hFind = ::FindFirstFile(findPath.c_str(), &findData);
-    if (hFind != INVALID_HANDLE_VALUE) {
-        do {
-            bool isHidden = (findData.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) != 0;
-            bool isParent = (wcscmp(findData.cFileName, L"..") == 0);
-            bool isCurrent = (wcscmp(findData.cFileName, L".") == 0);
-
-            if (isParent) {
-                if (!includeParent) continue;
-                // Always include parent if requested, even if hidden
-            }
-            else {
-                if (isCurrent || (isHidden && !showHidden) || findData.cFileName[0] == L'?') {
-                    continue;
-                }
-            }
+DirectoryEnumerator::~DirectoryEnumerator()
+{
+    if (_state->hFind != nullptr && _state->hFind != INVALID_HANDLE_VALUE) {
+        ::FindClose(_state->hFind);
+    }
+}
+
+bool DirectoryEnumerator::Read(std::vector<FileSystemEntry>& entries, size_t maxCount)
+{
+    ThreadErrorModeGuard guard;
+    State& state = *_state;
+    if (!state.atEnd && state.hFind == nullptr) {
+        state.hFind = ::FindFirstFile(state.findPath.c_str(), &state.findData);
+        state.atEnd = (state.hFind == INVALID_HANDLE_VALUE);
+    }
 
+    size_t count = 0;
+    while (!state.atEnd && count < maxCount) {
+        const WIN32_FIND_DATA& findData = state.findData;
+        bool isHidden = (findData.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) != 0;
+        bool isParent = (wcscmp(findData.cFileName, L"..") == 0);
+        bool isCurrent = (wcscmp(findData.cFileName, L".") == 0);
+
+        // Always include parent if requested, even if hidden
+        bool isListed = isParent ? state.includeParent : !(isCurrent || (isHidden && !state.showHidden) || findData.cFileName[0] == L'?');
+        if (isListed) {
             size_t fileSize = static_cast<size_t>((static_cast<unsigned __int64>(findData.nFileSizeHigh) << 32) + findData.nFileSizeLow);
 
             unsigned __int64 ull = (static_cast<unsigned __int64>(findData.ftLastWriteTime.dwHighDateTime) << 32) + findData.ftLastWriteTime.dwLowDateTime;
             time_t lastWriteTime = static_cast<time_t>((ull - 116444736000000000ULL) / 10000000ULL);
 
             entries.emplace_back(findData.cFileName, static_cast<unsigned int>(findData.dwFileAttributes), fileSize, lastWriteTime, isParent);
-        } while (::FindNextFile(hFind, &findData));
-        ::FindClose(hFind);
+            ++count;
+        }
+
+        if (!::FindNextFile(state.hFind, &state.findData)) {
+            ::FindClose(state.hFind);
+            state.hFind = INVALID_HANDLE_VALUE;
+            state.atEnd = true;
+        }
     }
-    return entries;
+    return !state.atEnd;
 }
 
 bool FileSystemService::CreateNewFile(const std::wstring& filePath)
@@ -2,9 +2,12 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <optional>
 #include <ctime>
 
+class FileFilter;
+
 class FileSystemEntry {
 public:
     FileSystemEntry(const std::wstring& name, unsigned int attributes, size_t fileSize, time_t lastWriteTime, bool isParent = false);
@@ -19,21 +22,41 @@ public:
     bool IsHidden() const;
     bool IsParent() const;
 
+    bool operator==(const FileSystemEntry& other) const = default;
+
 private:
     std::wstring _name;
-    unsigned int _attributes;
     size_t _fileSize;
     time_t _lastWriteTime;
+    unsigned int _attributes;
     bool _isParent;
 };
 
+// Reads a directory in batches, so that a huge folder can be shown while it
+// is still being read. The directory is opened by the first Read().
+class DirectoryEnumerator {
+public:
+    DirectoryEnumerator(const std::wstring& path, bool showHidden, bool includeParent = false);
+    ~DirectoryEnumerator();
+    DirectoryEnumerator(const DirectoryEnumerator&) = delete;
+    DirectoryEnumerator& operator=(const DirectoryEnumerator&) = delete;
+
+    // Appends up to maxCount entries; returns false once the directory is exhausted.
+    bool Read(std::vector<FileSystemEntry>& entries, size_t maxCount);
+
+private:
+    struct State;
+    std::unique_ptr<State> _state;
+};
+
 class FileSystemService {
 public:
     static std::vector<std::wstring> GetLogicalDrives();
     static std::optional<std::wstring> GetVolumeName(const std::wstring& drivePath);
     static std::wstring GetRemotePath(const std::wstring& drivePath);
 
-    static bool HaveChildren(const std::wstring& folderPath, bool useFullTree, bool showHidden);
+    // Folders the filter excludes are not counted, and files only when they match
+    static bool HaveChildren(const std::wstring& folderPath, bool useFullTree, bool showHidden, const FileFilter& filter);
     static std::vector<FileSystemEntry> GetDirectoryEntries(const std::wstring& path, bool showHidden, bool includeParent = false);
     static std::wstring CombinePath(const std::wstring& parent, const std::wstring& child);
 
@@ -35,25 +35,29 @@ constexpr DWORD operator "" _KB(unsigned long long value) {
 }
 
 FileSystemWatcher::FileSystemWatcher()
-    : m_stop(false)
+    : m_stopEvent(::CreateEvent(nullptr, TRUE, FALSE, nullptr))
 {
 }
 
 FileSystemWatcher::~FileSystemWatcher()
 {
     Stop();
+    if (m_stopEvent) {
+        ::CloseHandle(m_stopEvent);
+    }
 }
 void FileSystemWatcher::Reset(const std::wstring& directory)
 {
     Stop();
-    m_stop = false;
+    ::ResetEvent(m_stopEvent);
     m_directory = directory;
     m_thread = std::thread(&FileSystemWatcher::Run, this);
 }
 
 void FileSystemWatcher::Stop()
 {
-    m_stop = true;
+    // Wakes the watcher thread at once, so that switching directories does not block.
+    ::SetEvent(m_stopEvent);
     if (m_thread.joinable()) {
         m_thread.join();
     }
@@ -74,6 +78,16 @@ void FileSystemWatcher::Renamed(RenamedCallback callback)
     m_renamedCallback = std::move(callback);
 }
 
+void FileSystemWatcher::Modified(ModifiedCallback callback)
+{
+    m_modifiedCallback = std::move(callback);
+}
+
+void FileSystemWatcher::Overflowed(OverflowCallback callback)
+{
+    m_overflowCallback = std::move(callback);
+}
+
 void FileSystemWatcher::Run()
 {
     HANDLE hDir = ::CreateFileW(
@@ -93,16 +107,21 @@ void FileSystemWatcher::Run()
     constexpr DWORD NOTIFY_FILTER   = FILE_NOTIFY_CHANGE_FILE_NAME
                                     | FILE_NOTIFY_CHANGE_DIR_NAME
                                     | FILE_NOTIFY_CHANGE_CREATION;
+    constexpr DWORD MODIFY_FILTER   = FILE_NOTIFY_CHANGE_SIZE
+                                    | FILE_NOTIFY_CHANGE_LAST_WRITE
+                                    | FILE_NOTIFY_CHANGE_ATTRIBUTES;
+    const DWORD notifyFilter = m_modifiedCallback ? (NOTIFY_FILTER | MODIFY_FILTER) : NOTIFY_FILTER;
 
     DWORD bufferSize = 16_KB;
     auto buffer = std::make_unique<BYTE[]>(bufferSize);
 
     HANDLE hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
     if (nullptr == hEvent) {
+        CloseHandle(hDir);
         return;
     }
 
-    while (!m_stop) {
+    while (true) {
         ResetEvent(hEvent);
         OVERLAPPED olp{
             .hEvent = hEvent
@@ -113,7 +132,7 @@ void FileSystemWatcher::Run()
             buffer.get(),   // Buffer
             bufferSize,     // Buffer Length
             TRUE,           // Watch Subtree
-            NOTIFY_FILTER,  // Notify Filter
+            notifyFilter,   // Notify Filter
             nullptr,        // Bytes Returned
             &olp,           // Overlapped
             nullptr         // Completion Routine
@@ -129,14 +148,9 @@ void FileSystemWatcher::Run()
             break;
         }
 
-        while (!m_stop) {
-            DWORD waitResult = WaitForSingleObject(hEvent, 500);
-            if (waitResult != WAIT_TIMEOUT) {
-                break;
-            }
-        }
-
-        if (m_stop) {
+        const HANDLE waitHandles[] = { hEvent, m_stopEvent };
+        DWORD waitResult = WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE);
+        if (waitResult != WAIT_OBJECT_0) {
             CancelIo(hDir);
             WaitForSingleObject(hEvent, INFINITE);
             break;
@@ -150,7 +164,10 @@ void FileSystemWatcher::Run()
         }
 
         if (retsize == 0) {
-            // buffer over, retry.
+            // buffer over: the changes are lost, so let the owner start over.
+            if (m_overflowCallback) {
+                m_overflowCallback();
+            }
             continue;
         }
 
@@ -180,6 +197,11 @@ void FileSystemWatcher::Run()
                     oldName.clear();
                 }
             }
+            else if (info->Action == FILE_ACTION_MODIFIED) {
+                if (m_modifiedCallback) {
+                    m_modifiedCallback(m_directory + filename);
+                }
+            }
             else {
                 ;
             }
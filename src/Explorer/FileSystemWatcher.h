@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 #pragma once
 
+#include <Windows.h>
 #include <string>
 #include <functional>
 #include <filesystem>
@@ -43,14 +44,26 @@ public:
     using RenamedCallback = std::function<void(const std::filesystem::path&, const std::filesystem::path&)>;
     void Renamed(RenamedCallback callback);
 
+    // Size, time stamp and attribute changes are only watched if this callback is set.
+    using ModifiedCallback = std::function<void(const std::filesystem::path&)>;
+    void Modified(ModifiedCallback callback);
+
+    // Called when changes were lost because the notification buffer overflowed.
+    using OverflowCallback = std::function<void()>;
+    void Overflowed(OverflowCallback callback);
+
+    const std::wstring& Directory() const { return m_directory; }
+
 private:
     void Run();
 
     std::thread                 m_thread;
-    bool                        m_stop;
+    HANDLE                      m_stopEvent;
     std::wstring                m_directory;
 
     CreatedCallback             m_createdCallback;
     DeletedCallback             m_deletedCallback;
     RenamedCallback             m_renamedCallback;
+    ModifiedCallback            m_modifiedCallback;
+    OverflowCallback            m_overflowCallback;
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IconIndexCache.h"
+
+#include <array>
+#include <cwctype>
+#include <mutex>
+
+namespace {
+// Extensions whose icon is read from the file.
+constexpr std::array<std::wstring_view, 3> OWN_ICON_EXTENSIONS = { L".exe", L".lnk", L".ico" };
+
+// Cannot occur in an extension, so it keys the folder icon.
+constexpr std::wstring_view DIRECTORY_KEY = L"\\";
+} // namespace
+
+IconIndexCache& IconIndexCache::Instance()
+{
+    static IconIndexCache instance;
+    return instance;
+}
+
+std::optional<std::wstring> IconIndexCache::MakeKey(std::wstring_view path, bool isDirectory, Lookup lookup)
+{
+    std::wstring key(1, static_cast<wchar_t>(lookup));
+    if (isDirectory) {
+        return key.append(DIRECTORY_KEY);
+    }
+
+    // FetchIcons() appends a separator to a path without a file name.
+    while (!path.empty() && (path.back() == L'\\' || path.back() == L'/')) {
+        path.remove_suffix(1);
+    }
+
+    const size_t nameBegin = path.find_last_of(L"\\/");
+    const std::wstring_view name = (nameBegin == std::wstring_view::npos) ? path : path.substr(nameBegin + 1);
+    const size_t extPos = name.find_last_of(L'.');
+
+    if (extPos != std::wstring_view::npos) {
+        key.reserve(1 + name.size() - extPos);
+        for (wchar_t c : name.substr(extPos)) {
+            key.push_back(static_cast<wchar_t>(std::towlower(c)));
+        }
+    }
+    for (const auto& extension : OWN_ICON_EXTENSIONS) {
+        if (std::wstring_view(key).substr(1) == extension) {
+            return std::nullopt;
+        }
+    }
+    return key;
+}
+
+std::optional<IconIndices> IconIndexCache::Find(const std::wstring& key) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto it = _indices.find(key);
+    if (it == _indices.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void IconIndexCache::Store(const std::wstring& key, const IconIndices& indices)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _indices[key] = indices;
+}
@@ -0,0 +1,69 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// @brief Indices into the system image list.
+struct IconIndices {
+    int normal;
+    int selected;
+    int overlay;
+};
+
+/// @brief Process-wide cache of system icon indices by file type.
+///
+/// Asked with SHGFI_USEFILEATTRIBUTES, the shell derives an icon from the
+/// extension and the directory attribute alone, so one lookup serves every
+/// file of a type. Types that carry their own icon (.exe, .lnk, .ico) have
+/// no key. Overlays belong to a single file, so entries never carry one and
+/// callers that need it ask the shell for the file itself. The cache is
+/// thread-safe.
+class IconIndexCache {
+public:
+    /// @brief The lookup that produced an entry. Lookups made with different
+    ///        flags get different selected indices and never share a key.
+    enum class Lookup : wchar_t {
+        SystemIndex = L'S', ///< GetIcons(): the selected index is the open icon.
+        SmallIcon   = L'I', ///< FetchIcons(): the selected index is the normal one.
+    };
+
+    static IconIndexCache& Instance();
+
+    /// @brief Returns the cache key of @p path for @p lookup, or std::nullopt
+    ///        if its icon depends on the file itself.
+    static std::optional<std::wstring> MakeKey(std::wstring_view path, bool isDirectory, Lookup lookup);
+
+    std::optional<IconIndices> Find(const std::wstring& key) const;
+    void Store(const std::wstring& key, const IconIndices& indices);
+
+private:
+    IconIndexCache() = default;
+
+    mutable std::shared_mutex _mutex;
+    std::unordered_map<std::wstring, IconIndices> _indices;
+};
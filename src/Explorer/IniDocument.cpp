@@ -0,0 +1,267 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "IniDocument.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "UTF16Stream.h"
+#endif
+
+namespace {
+
+bool EqualsNoCase(std::wstring_view lhs, std::wstring_view rhs)
+{
+    return std::ranges::equal(lhs, rhs, [](wchar_t a, wchar_t b) {
+        return std::towlower(a) == std::towlower(b);
+    });
+}
+
+std::wstring_view Trim(std::wstring_view s)
+{
+    const size_t first = s.find_first_not_of(L" \t");
+    if (first == std::wstring_view::npos) {
+        return {};
+    }
+    const size_t last = s.find_last_not_of(L" \t");
+    return s.substr(first, last - first + 1);
+}
+
+} // namespace
+
+#ifdef _WIN32
+namespace {
+constexpr char UTF16LE_BOM[] = { '\xFF', '\xFE' };
+} // namespace
+
+bool IniDocument::Load(const std::filesystem::path& path)
+{
+    _sections.clear();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return !ec;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        return false;
+    }
+
+    std::wstring text;
+    if (bytes.size() >= 2 && bytes[0] == UTF16LE_BOM[0] && bytes[1] == UTF16LE_BOM[1]) {
+        text.reserve(bytes.size() / 2);
+        for (size_t i = 2; i + 1 < bytes.size(); i += 2) {
+            text.push_back(static_cast<wchar_t>(static_cast<unsigned char>(bytes[i]) | (static_cast<unsigned char>(bytes[i + 1]) << 8)));
+        }
+    } else if (!bytes.empty()) {
+        // Without a byte order mark the file was written by the ANSI profile functions
+        const int length = ::MultiByteToWideChar(CP_ACP, 0, bytes.data(), static_cast<int>(bytes.size()), nullptr, 0);
+        if (length <= 0) {
+            return false;
+        }
+        text.resize(static_cast<size_t>(length));
+        ::MultiByteToWideChar(CP_ACP, 0, bytes.data(), static_cast<int>(bytes.size()), text.data(), length);
+    }
+    Parse(text);
+    return true;
+}
+
+bool IniDocument::Save(const std::filesystem::path& path) const
+{
+    return WriteUtf16FileAtomically(path, Serialize());
+}
+#endif
+
+void IniDocument::Parse(std::wstring_view text)
+{
+    _sections.clear();
+    _sections.push_back({});
+
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find(L'\n', begin);
+        if (end == std::wstring_view::npos) {
+            end = text.size();
+        }
+        std::wstring_view line = text.substr(begin, end - begin);
+        if (!line.empty() && line.back() == L'\r') {
+            line.remove_suffix(1);
+        }
+        begin = end + 1;
+
+        const std::wstring_view trimmed = Trim(line);
+        if (trimmed.starts_with(L'[')) {
+            const size_t close = trimmed.find(L']');
+            const std::wstring_view name = trimmed.substr(1, (close == std::wstring_view::npos) ? std::wstring_view::npos : close - 1);
+            _sections.push_back({ std::wstring(Trim(name)), {} });
+            continue;
+        }
+
+        const size_t equal = trimmed.find(L'=');
+        if (equal == std::wstring_view::npos || equal == 0 || trimmed.starts_with(L';')) {
+            _sections.back().lines.push_back({ {}, std::wstring(line) });
+        } else {
+            _sections.back().lines.push_back({ std::wstring(Trim(trimmed.substr(0, equal))), std::wstring(Trim(trimmed.substr(equal + 1))) });
+        }
+    }
+}
+
+std::wstring IniDocument::Serialize() const
+{
+    std::wstring text;
+    for (const auto& section : _sections) {
+        if (!section.name.empty()) {
+            text.append(L"[").append(section.name).append(L"]\r\n");
+        }
+        for (const auto& line : section.lines) {
+            if (!line.key.empty()) {
+                text.append(line.key).append(L"=");
+            }
+            text.append(line.value).append(L"\r\n");
+        }
+    }
+    return text;
+}
+
+std::optional<std::wstring> IniDocument::Find(std::wstring_view section, std::wstring_view key) const
+{
+    if (const Section* found = FindSection(section)) {
+        for (const auto& line : found->lines) {
+            if (!line.key.empty() && EqualsNoCase(line.key, key)) {
+                return line.value;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::wstring IniDocument::GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const
+{
+    std::optional<std::wstring> value = Find(section, key);
+    if (!value) {
+        return std::wstring(defaultValue);
+    }
+    // A value in matching quotes is returned without them, as by GetPrivateProfileString
+    if (value->size() >= 2 && (value->front() == L'"' || value->front() == L'\'') && value->back() == value->front()) {
+        return value->substr(1, value->size() - 2);
+    }
+    return *value;
+}
+
+int IniDocument::GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const
+{
+    const std::optional<std::wstring> value = Find(section, key);
+    if (!value) {
+        return defaultValue;
+    }
+
+    // Leading digits only, like GetPrivateProfileInt
+    size_t pos = 0;
+    const bool isNegative = (pos < value->size() && (*value)[pos] == L'-');
+    if (isNegative || (pos < value->size() && (*value)[pos] == L'+')) {
+        pos++;
+    }
+    long long number = 0;
+    const size_t firstDigit = pos;
+    for (; pos < value->size() && L'0' <= (*value)[pos] && (*value)[pos] <= L'9'; ++pos) {
+        number = std::min(number * 10 + ((*value)[pos] - L'0'), 0x80000000LL);
+    }
+    if (pos == firstDigit) {
+        return defaultValue;
+    }
+    return static_cast<int>(isNegative ? -number : std::min(number, 0x7FFFFFFFLL));
+}
+
+bool IniDocument::GetBool(std::wstring_view section, std::wstring_view key, bool defaultValue) const
+{
+    return GetInt(section, key, defaultValue ? 1 : 0) != 0;
+}
+
+void IniDocument::SetString(std::wstring_view section, std::wstring_view key, std::wstring_view value)
+{
+    Section& target = GetOrAddSection(section);
+    for (auto& line : target.lines) {
+        if (!line.key.empty() && EqualsNoCase(line.key, key)) {
+            line.value = value;
+            return;
+        }
+    }
+
+    // New keys go after the last key, ahead of trailing blank lines
+    auto position = std::find_if(target.lines.rbegin(), target.lines.rend(), [](const Line& line) {
+        return !line.key.empty() || !Trim(line.value).empty();
+    }).base();
+    target.lines.insert(position, { std::wstring(key), std::wstring(value) });
+}
+
+void IniDocument::SetInt(std::wstring_view section, std::wstring_view key, int value)
+{
+    SetString(section, key, std::to_wstring(value));
+}
+
+void IniDocument::SetBool(std::wstring_view section, std::wstring_view key, bool value)
+{
+    SetString(section, key, value ? L"1" : L"0");
+}
+
+void IniDocument::ClearSection(std::wstring_view section)
+{
+    for (auto& candidate : _sections) {
+        if (!candidate.name.empty() && EqualsNoCase(candidate.name, section)) {
+            std::erase_if(candidate.lines, [](const Line& line) {
+                return !line.key.empty();
+            });
+        }
+    }
+}
+
+const IniDocument::Section* IniDocument::FindSection(std::wstring_view name) const
+{
+    for (const auto& section : _sections) {
+        if (!section.name.empty() && EqualsNoCase(section.name, name)) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+IniDocument::Section& IniDocument::GetOrAddSection(std::wstring_view name)
+{
+    for (auto& section : _sections) {
+        if (!section.name.empty() && EqualsNoCase(section.name, name)) {
+            return section;
+        }
+    }
+    return _sections.emplace_back(Section{ std::wstring(name), {} });
+}
@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief In-memory model of an ini file.
+///
+/// The file is parsed once, read and changed through typed accessors and
+/// written back in one pass. Keys and section names are matched without
+/// regard to case, like the Win32 profile functions do; lines that are not
+/// key/value pairs, such as comments, are kept as they are. Files are read
+/// as UTF-16LE when they start with a byte order mark and in the ANSI code
+/// page otherwise, and are always written as UTF-16LE with a byte order mark.
+/// Only Load and Save use Win32; the rest builds on any host for testing.
+class IniDocument {
+public:
+    /// @brief Replaces the document with the file at @p path. A missing file
+    ///        gives an empty document; returns false if it cannot be read.
+    bool Load(const std::filesystem::path& path);
+
+    /// @brief Writes the document to a temporary file next to @p path, flushes
+    ///        it to disk and renames it over @p path, so a failed save or a
+    ///        crash leaves either the old file or the new one.
+    bool Save(const std::filesystem::path& path) const;
+
+    void Parse(std::wstring_view text);
+    std::wstring Serialize() const;
+
+    std::optional<std::wstring> Find(std::wstring_view section, std::wstring_view key) const;
+    std::wstring GetString(std::wstring_view section, std::wstring_view key, std::wstring_view defaultValue) const;
+    int GetInt(std::wstring_view section, std::wstring_view key, int defaultValue) const;
+    bool GetBool(std::wstring_view section, std::wstring_view key, bool defaultValue) const;
+
+    void SetString(std::wstring_view section, std::wstring_view key, std::wstring_view value);
+    void SetInt(std::wstring_view section, std::wstring_view key, int value);
+    void SetBool(std::wstring_view section, std::wstring_view key, bool value);
+
+    /// @brief Removes all keys of @p section, keeping the section itself.
+    void ClearSection(std::wstring_view section);
+
+private:
+    struct Line {
+        std::wstring key;       // empty: a comment or blank line, kept verbatim in value
+        std::wstring value;
+    };
+    struct Section {
+        std::wstring name;      // empty for the lines before the first section
+        std::vector<Line> lines;
+    };
+
+    const Section* FindSection(std::wstring_view name) const;
+    Section& GetOrAddSection(std::wstring_view name);
+
+    std::vector<Section> _sections;
+};
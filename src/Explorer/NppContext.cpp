@@ -262,6 +262,33 @@ int NppContext::GetNbOpenFiles()
     return (INT)::SendMessage(_nppData._nppHandle, NPPM_GETNBOPENFILES, 0, ALL_OPEN_FILES);
 }
 
+std::vector<UINT_PTR> NppContext::GetOpenBufferIds()
+{
+    std::vector<UINT_PTR> bufferIds;
+    const std::pair<int, int> views[] = { { PRIMARY_VIEW, MAIN_VIEW }, { SECOND_VIEW, SUB_VIEW } };
+    for (const auto& [countView, view] : views) {
+        int docCnt = (INT)::SendMessage(_nppData._nppHandle, NPPM_GETNBOPENFILES, 0, countView);
+        for (int i = 0; i < docCnt; i++) {
+            UINT_PTR bufferId = (UINT_PTR)::SendMessage(_nppData._nppHandle, NPPM_GETBUFFERIDFROMPOS, i, view);
+            if (bufferId != 0) {
+                bufferIds.push_back(bufferId);
+            }
+        }
+    }
+    return bufferIds;
+}
+
+std::wstring NppContext::GetFullPathFromBufferId(UINT_PTR bufferId)
+{
+    LRESULT length = ::SendMessage(_nppData._nppHandle, NPPM_GETFULLPATHFROMBUFFERID, bufferId, 0);
+    if (length <= 0) {
+        return {};
+    }
+    std::vector<WCHAR> path(length + 1);
+    ::SendMessage(_nppData._nppHandle, NPPM_GETFULLPATHFROMBUFFERID, bufferId, (LPARAM)path.data());
+    return { path.data(), static_cast<size_t>(length) };
+}
+
 bool NppContext::GetOpenFileNames(std::vector<std::wstring>& fileNames)
 {
     int docCnt = GetNbOpenFiles();
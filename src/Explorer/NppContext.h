@@ -9,6 +9,10 @@ public:
 
     void SetNppData(NppData nppData);
 
+    // Open documents by buffer; a cloned document is listed once per view.
+    std::vector<UINT_PTR> GetOpenBufferIds();
+    std::wstring GetFullPathFromBufferId(UINT_PTR bufferId);
+
     // IPluginContext implementation
     HWND GetWindow() const override;
     bool DoOpen(const std::filesystem::path& path) override;
@@ -0,0 +1,252 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "PathTable.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <mutex>
+
+namespace {
+wchar_t FoldChar(wchar_t c)
+{
+    return (c == L'/') ? L'\\' : static_cast<wchar_t>(std::towlower(c));
+}
+} // namespace
+
+PathTable& PathTable::Instance()
+{
+    static PathTable instance;
+    return instance;
+}
+
+PathId PathTable::Intern(std::wstring_view path)
+{
+    const std::vector<std::wstring_view> segments = Split(path);
+    if (segments.empty()) {
+        return INVALID_PATH_ID;
+    }
+
+    // Most paths are already known; only take the exclusive lock to add.
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        PathId id = INVALID_PATH_ID;
+        for (const auto& segment : segments) {
+            id = FindChild(id, segment, Hash(id, segment));
+            if (id == INVALID_PATH_ID) {
+                break;
+            }
+        }
+        if (id != INVALID_PATH_ID) {
+            return id;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    PathId id = INVALID_PATH_ID;
+    for (const auto& segment : segments) {
+        const size_t hash = Hash(id, segment);
+        const PathId child = FindChild(id, segment, hash);
+        id = (child != INVALID_PATH_ID) ? child : AddChild(id, segment, hash);
+    }
+    return id;
+}
+
+PathId PathTable::Find(std::wstring_view path) const
+{
+    const std::vector<std::wstring_view> segments = Split(path);
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    PathId id = INVALID_PATH_ID;
+    for (const auto& segment : segments) {
+        id = FindChild(id, segment, Hash(id, segment));
+        if (id == INVALID_PATH_ID) {
+            break;
+        }
+    }
+    return id;
+}
+
+PathId PathTable::Parent(PathId id) const
+{
+    if (id == INVALID_PATH_ID) {
+        return INVALID_PATH_ID;
+    }
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _nodes[id - 1].parent;
+}
+
+bool PathTable::IsSameOrDescendant(PathId id, PathId ancestor) const
+{
+    if (id == INVALID_PATH_ID || ancestor == INVALID_PATH_ID) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    while (id != INVALID_PATH_ID) {
+        if (id == ancestor) {
+            return true;
+        }
+        id = _nodes[id - 1].parent;
+    }
+    return false;
+}
+
+PathId PathTable::Rebase(PathId id, PathId oldAncestor, PathId newAncestor)
+{
+    if (id == INVALID_PATH_ID || oldAncestor == INVALID_PATH_ID || newAncestor == INVALID_PATH_ID) {
+        return INVALID_PATH_ID;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    std::vector<PathId> relative;
+    while (id != oldAncestor) {
+        if (id == INVALID_PATH_ID) {
+            return INVALID_PATH_ID;
+        }
+        relative.push_back(id);
+        id = _nodes[id - 1].parent;
+    }
+
+    PathId result = newAncestor;
+    for (auto it = relative.rbegin(); it != relative.rend(); ++it) {
+        const std::wstring& name = _nodes[*it - 1].name;
+        const size_t hash = Hash(result, name);
+        const PathId child = FindChild(result, name, hash);
+        result = (child != INVALID_PATH_ID) ? child : AddChild(result, name, hash);
+    }
+    return result;
+}
+
+std::wstring PathTable::ToString(PathId id) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return ToStringLocked(id);
+}
+
+std::wstring PathTable::Name(PathId id) const
+{
+    if (id == INVALID_PATH_ID) {
+        return {};
+    }
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _nodes[id - 1].name;
+}
+
+size_t PathTable::Size() const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _nodes.size();
+}
+
+PathId PathTable::FindChild(PathId parent, std::wstring_view name, size_t hash) const
+{
+    auto [begin, end] = _children.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        const Node& node = _nodes[it->second - 1];
+        if (node.parent == parent && EqualsIgnoreCase(node.name, name)) {
+            return it->second;
+        }
+    }
+    return INVALID_PATH_ID;
+}
+
+PathId PathTable::AddChild(PathId parent, std::wstring_view name, size_t hash)
+{
+    _nodes.push_back({ parent, std::wstring(name) });
+    const PathId id = static_cast<PathId>(_nodes.size());
+    _children.emplace(hash, id);
+    return id;
+}
+
+std::wstring PathTable::ToStringLocked(PathId id) const
+{
+    std::vector<const std::wstring*> names;
+    size_t length = 0;
+    for (; id != INVALID_PATH_ID; id = _nodes[id - 1].parent) {
+        names.push_back(&_nodes[id - 1].name);
+        length += names.back()->size() + 1;
+    }
+
+    std::wstring path;
+    path.reserve(length + 1);
+    for (auto it = names.rbegin(); it != names.rend(); ++it) {
+        if (it != names.rbegin()) {
+            path += L'\\';
+        }
+        path += **it;
+    }
+    if (names.size() == 1 && path.size() == 2 && path[1] == L':') {
+        path += L'\\';
+    }
+    return path;
+}
+
+std::vector<std::wstring_view> PathTable::Split(std::wstring_view path)
+{
+    auto isSeparator = [](wchar_t c) { return c == L'\\' || c == L'/'; };
+
+    std::vector<std::wstring_view> segments;
+    size_t pos = 0;
+
+    // "\\server" (or "\\?") stays one segment so that UNC paths keep their prefix
+    if (path.size() >= 2 && isSeparator(path[0]) && isSeparator(path[1])) {
+        size_t end = 2;
+        while (end < path.size() && !isSeparator(path[end])) {
+            ++end;
+        }
+        segments.push_back(path.substr(0, end));
+        pos = end;
+    }
+
+    while (pos < path.size()) {
+        while (pos < path.size() && isSeparator(path[pos])) {
+            ++pos;
+        }
+        size_t end = pos;
+        while (end < path.size() && !isSeparator(path[end])) {
+            ++end;
+        }
+        if (end > pos) {
+            segments.push_back(path.substr(pos, end - pos));
+        }
+        pos = end;
+    }
+    return segments;
+}
+
+size_t PathTable::Hash(PathId parent, std::wstring_view name)
+{
+    // FNV-1a over the parent id and the case-folded name
+    uint64_t hash = 14695981039346656037ull ^ parent;
+    hash *= 1099511628211ull;
+    for (wchar_t c : name) {
+        hash ^= static_cast<uint64_t>(FoldChar(c));
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool PathTable::EqualsIgnoreCase(std::wstring_view lhs, std::wstring_view rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](wchar_t a, wchar_t b) {
+        return FoldChar(a) == FoldChar(b);
+    });
+}
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using PathId = uint32_t;
+constexpr PathId INVALID_PATH_ID = 0;
+
+/// @brief Process-wide table of interned absolute paths.
+///
+/// A path is stored as a chain of segments that point at their parent, so
+/// paths below the same directory share its storage. Lookups ignore case,
+/// accept '/' as a separator and ignore trailing separators, which makes two
+/// ids equal exactly when their paths name the same location. Ids stay valid
+/// for the lifetime of the process. The table is thread-safe.
+class PathTable {
+public:
+    static PathTable& Instance();
+
+    /// @brief Returns the id of @p path, adding it and its ancestors if needed.
+    PathId Intern(std::wstring_view path);
+
+    /// @brief Returns the id of @p path, or INVALID_PATH_ID if it was never interned.
+    PathId Find(std::wstring_view path) const;
+
+    PathId Parent(PathId id) const;
+
+    /// @brief Returns true if @p id is @p ancestor or lies below it.
+    bool IsSameOrDescendant(PathId id, PathId ancestor) const;
+
+    /// @brief Moves @p id from below @p oldAncestor to below @p newAncestor.
+    /// @return The id of the moved path, or INVALID_PATH_ID if @p id does not
+    ///         lie below @p oldAncestor.
+    PathId Rebase(PathId id, PathId oldAncestor, PathId newAncestor);
+
+    /// @brief Materializes the path. Only a drive root keeps its trailing backslash.
+    std::wstring ToString(PathId id) const;
+
+    /// @brief Returns the last segment of the path.
+    std::wstring Name(PathId id) const;
+
+    size_t Size() const;
+
+private:
+    struct Node {
+        PathId parent;
+        std::wstring name;
+    };
+
+    PathTable() = default;
+
+    PathId FindChild(PathId parent, std::wstring_view name, size_t hash) const;
+    PathId AddChild(PathId parent, std::wstring_view name, size_t hash);
+    std::wstring ToStringLocked(PathId id) const;
+
+    static std::vector<std::wstring_view> Split(std::wstring_view path);
+    static size_t Hash(PathId parent, std::wstring_view name);
+    static bool EqualsIgnoreCase(std::wstring_view lhs, std::wstring_view rhs);
+
+    mutable std::shared_mutex _mutex;
+    std::deque<Node> _nodes;                            // node of id N is _nodes[N - 1]
+    std::unordered_multimap<size_t, PathId> _children;  // Hash(parent, name) -> id
+};
@@ -97,26 +97,32 @@ namespace {
         }
         return pathStr;
     }
+
+    // True if path is dir itself or lies below it; case is ignored like the file system does.
+    bool IsSameOrBelow(std::wstring_view path, std::wstring_view dir) {
+        while (!dir.empty() && (dir.back() == L'\\' || dir.back() == L'/')) {
+            dir.remove_suffix(1);
+        }
+        if (path.size() < dir.size()) {
+            return false;
+        }
+        if (::CompareStringOrdinal(path.data(), static_cast<int>(dir.size()), dir.data(), static_cast<int>(dir.size()), TRUE) != CSTR_EQUAL) {
+            return false;
+        }
+        return (path.size() == dir.size()) || (path[dir.size()] == L'\\') || (path[dir.size()] == L'/');
+    }
 }
 
 class QuickOpenEntry {
 public:
     QuickOpenEntry() = delete;
-    explicit QuickOpenEntry(const std::wstring& path, const std::wstring& rootPath)
+    explicit QuickOpenEntry(const std::wstring& path, std::shared_ptr<const std::wstring> rootPath)
         : _fullPath(path)
-        , _rootPath(rootPath)
+        , _rootPath(std::move(rootPath))
+        , _relativeOffset(RelativeOffset(_fullPath, *_rootPath))
         , _score(0)
         , _matchType(MATCH_TYPE::INIT)
     {
-        std::wstring cleanRoot = rootPath;
-        if (!cleanRoot.empty() && cleanRoot.back() != L'\\') {
-            cleanRoot.push_back(L'\\');
-        }
-        if (_fullPath.starts_with(cleanRoot)) {
-            _relativePath = _fullPath.substr(cleanRoot.size());
-        } else {
-            _relativePath = _fullPath;
-        }
     }
 
     ~QuickOpenEntry()
@@ -125,45 +131,35 @@ public:
 
     std::wstring_view FileName() const
     {
-        std::wstring_view result(_relativePath);
+        std::wstring_view result = RelativePath();
         size_t lastSlashPos = result.find_last_of(L"/\\");
         if (lastSlashPos != std::wstring_view::npos) {
             return result.substr(lastSlashPos + 1);
         }
-        return _relativePath;
+        return result;
     }
 
-    const std::wstring& RelativePath() const
+    // A tail of the full path, so it is null-terminated
+    std::wstring_view RelativePath() const
     {
-        return _relativePath;
+        return std::wstring_view(_fullPath).substr(_relativeOffset);
     }
 
-    void Rename(const std::wstring& oldName, const std::wstring& newName)
+    // Moves the entry from below oldPath (or from oldPath itself) to newPath.
+    void Rename(const std::wstring& oldPath, const std::wstring& newPath)
     {
-        std::string::size_type pos = _fullPath.find(oldName);
-        if (pos == 0) {
-            _fullPath.replace(pos, oldName.length(), newName);
-            
-            std::wstring cleanRoot = _rootPath;
-            if (!cleanRoot.empty() && cleanRoot.back() != L'\\') {
-                cleanRoot.push_back(L'\\');
-            }
-            if (_fullPath.starts_with(cleanRoot)) {
-                _relativePath = _fullPath.substr(cleanRoot.size());
-            } else {
-                _relativePath = _fullPath;
-            }
-        }
+        _fullPath = newPath + _fullPath.substr(oldPath.size());
+        _relativeOffset = RelativeOffset(_fullPath, *_rootPath);
     }
 
-    std::wstring FullPath() const
+    const std::wstring& FullPath() const
     {
         return _fullPath;
     }
 
     const std::wstring& RootPath() const
     {
-        return _rootPath;
+        return *_rootPath;
     }
 
     enum class MATCH_TYPE {
@@ -206,10 +202,22 @@ public:
     }
 
 private:
+    static size_t RelativeOffset(const std::wstring& path, const std::wstring& rootPath)
+    {
+        std::wstring cleanRoot = rootPath;
+        if (!cleanRoot.empty() && cleanRoot.back() != L'\\') {
+            cleanRoot.push_back(L'\\');
+        }
+        if (path.starts_with(cleanRoot)) {
+            return cleanRoot.size();
+        }
+        return 0;
+    }
+
     static std::wstring s_rootPath;
-    std::wstring        _relativePath;
     std::wstring        _fullPath;
-    std::wstring        _rootPath;
+    std::shared_ptr<const std::wstring> _rootPath;  // shared by all entries of the root
+    size_t              _relativeOffset;
     int                 _score;
     std::vector<size_t> _matches;
     MATCH_TYPE          _matchType;
@@ -249,7 +257,7 @@ public:
     {
         {
             std::lock_guard<std::mutex> lock(_entriesMtx);
-            _entries.emplace_back(std::make_shared<QuickOpenEntry>(path, rootPath));
+            _entries.emplace_back(std::make_shared<QuickOpenEntry>(path, SharedRootPath(rootPath)));
         }
 
         {
@@ -263,25 +271,14 @@ public:
     {
         {
             std::lock_guard<std::mutex> lock(_entriesMtx);
-            auto it = std::find_if(_entries.begin(), _entries.end(), [&path](const auto entry) {
-                return entry->FullPath() == path;
-            });
-            // file was removed
-            if (it != _entries.end()) {
-                (*it)->ResetScore();
-                _entries.erase(it);
-            }
-            // directory was removed
-            else {
-                std::wstring dirName = path + L"\\";
-                for (it = _entries.begin(); it != _entries.end(); ) {
-                    if ((*it)->FullPath().starts_with(dirName)) {
-                        (*it)->ResetScore();
-                        it = _entries.erase(it);
-                    }
-                    else {
-                        ++it;
-                    }
+            // the removed file, or every file below the removed directory
+            for (auto it = _entries.begin(); it != _entries.end(); ) {
+                if (IsSameOrBelow((*it)->FullPath(), path)) {
+                    (*it)->ResetScore();
+                    it = _entries.erase(it);
+                }
+                else {
+                    ++it;
                 }
             }
         }
@@ -297,26 +294,11 @@ public:
     {
         {
             std::lock_guard<std::mutex> lock(_entriesMtx);
-            auto it = std::find_if(_entries.begin(), _entries.end(), [&oldPath](const auto entry) {
-                return entry->FullPath() == oldPath;
-            });
-            // file name was changed
-            if (it != _entries.end()) {
-                (*it)->Rename(oldPath, newPath);
-                (*it)->ResetScore();
-            }
-            // directory name was changed
-            else {
-                std::wstring oldDirName = oldPath + L"\\";
-                std::wstring newDirName = newPath + L"\\";
-                for (it = _entries.begin(); it != _entries.end(); ) {
-                    if ((*it)->FullPath().starts_with(oldDirName)) {
-                        (*it)->Rename(oldDirName, newDirName);
-                        (*it)->ResetScore();
-                    }
-                    else {
-                        ++it;
-                    }
+            // the renamed file, or every file below the renamed directory
+            for (auto& entry : _entries) {
+                if (IsSameOrBelow(entry->FullPath(), oldPath)) {
+                    entry->Rename(oldPath, newPath);
+                    entry->ResetScore();
                 }
             }
         }
@@ -380,6 +362,17 @@ public:
         }
     }
 private:
+    // Expects _entriesMtx to be held. There are only a few roots, so a scan is enough.
+    std::shared_ptr<const std::wstring> SharedRootPath(const std::wstring& rootPath)
+    {
+        for (const auto& shared : _sharedRootPaths) {
+            if (*shared == rootPath) {
+                return shared;
+            }
+        }
+        return _sharedRootPaths.emplace_back(std::make_shared<const std::wstring>(rootPath));
+    }
+
     void ClearEntries()
     {
         {
@@ -389,6 +382,7 @@ private:
         {
             std::lock_guard<std::mutex> lock(_entriesMtx);
             _entries.clear();
+            _sharedRootPaths.clear();
         }
     }
 
@@ -501,7 +495,7 @@ private:
                     std::lock_guard<std::mutex> lock(_entriesMtx);
                     std::sort(std::execution::par, results.begin(), results.end(), [](const auto& lhs, const auto& rhs) {
                         if (lhs->Score() == rhs->Score()) {
-                            return ::StrCmpLogicalW(lhs->RelativePath().c_str(), rhs->RelativePath().c_str()) < 0;
+                            return ::StrCmpLogicalW(lhs->RelativePath().data(), rhs->RelativePath().data()) < 0;
                         }
                         return lhs->Score() > rhs->Score();
                     });
@@ -526,6 +520,7 @@ private:
         std::optional<std::wstring> query;
     };
     std::list<std::shared_ptr<QuickOpenEntry>>  _entries;
+    std::vector<std::shared_ptr<const std::wstring>> _sharedRootPaths;
     std::mutex                                  _entriesMtx;
     std::vector<std::weak_ptr<QuickOpenEntry>>  _weakResults;
     std::mutex                                  _weakResultsMtx;
@@ -556,6 +551,7 @@ void QuickOpenDlg::init(HINSTANCE hInst, HWND parent, Settings* prop, IPluginCon
 {
     _pSettings = prop;
     _pluginContext = pluginContext;
+    _directoryReader.SetFilter(&prop->GetFileFilter());
 
     Window::init(hInst, parent);
     create(IDD_QUICK_OPEN_DLG, FALSE);
@@ -18,6 +18,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
 #include "Settings.h"
+#include "IniDocument.h"
+#include "PathTable.h"
 
 #include <shlwapi.h>
 #include <ranges>
@@ -67,40 +69,38 @@ constexpr WCHAR HideFolders[]       = L"HideFolders";
 constexpr WCHAR EXPLORER_INI[]      = L"Explorer.ini";
 
 // Helper functions for INI operations
-int ReadInt(const WCHAR* key, int defaultValue, const std::filesystem::path& iniPath) {
-    return ::GetPrivateProfileInt(SECTION_EXPLORER, key, defaultValue, iniPath.c_str());
+int ReadInt(const WCHAR* key, int defaultValue, const IniDocument& ini) {
+    return ini.GetInt(SECTION_EXPLORER, key, defaultValue);
 }
 
-void WriteInt(const WCHAR* key, int value, const std::filesystem::path& iniPath) {
-    ::WritePrivateProfileString(SECTION_EXPLORER, key, std::to_wstring(value).c_str(), iniPath.c_str());
+void WriteInt(const WCHAR* key, int value, IniDocument& ini) {
+    ini.SetInt(SECTION_EXPLORER, key, value);
 }
 
-bool ReadBool(const WCHAR* key, bool defaultValue, const std::filesystem::path& iniPath) {
-    return ::GetPrivateProfileInt(SECTION_EXPLORER, key, defaultValue ? TRUE : FALSE, iniPath.c_str()) != FALSE;
+bool ReadBool(const WCHAR* key, bool defaultValue, const IniDocument& ini) {
+    return ini.GetBool(SECTION_EXPLORER, key, defaultValue);
 }
 
-void WriteBool(const WCHAR* key, bool value, const std::filesystem::path& iniPath) {
-    ::WritePrivateProfileString(SECTION_EXPLORER, key, value ? L"1" : L"0", iniPath.c_str());
+void WriteBool(const WCHAR* key, bool value, IniDocument& ini) {
+    ini.SetBool(SECTION_EXPLORER, key, value);
 }
 
-std::wstring ReadString(const WCHAR* key, const WCHAR* defaultValue, const std::filesystem::path& iniPath) {
-    WCHAR temp[MAX_PATH];
-    ::GetPrivateProfileString(SECTION_EXPLORER, key, defaultValue, temp, MAX_PATH, iniPath.c_str());
-    return temp;
+std::wstring ReadString(const WCHAR* key, const WCHAR* defaultValue, const IniDocument& ini) {
+    return ini.GetString(SECTION_EXPLORER, key, defaultValue);
 }
 
-void WriteString(const WCHAR* key, const std::wstring& value, const std::filesystem::path& iniPath) {
-    ::WritePrivateProfileString(SECTION_EXPLORER, key, value.c_str(), iniPath.c_str());
+void WriteString(const WCHAR* key, const std::wstring& value, IniDocument& ini) {
+    ini.SetString(SECTION_EXPLORER, key, value);
 }
 
 template<typename T>
-T ReadEnum(const WCHAR* key, T defaultValue, const std::filesystem::path& iniPath) {
-    return static_cast<T>(::GetPrivateProfileInt(SECTION_EXPLORER, key, static_cast<int>(defaultValue), iniPath.c_str()));
+T ReadEnum(const WCHAR* key, T defaultValue, const IniDocument& ini) {
+    return static_cast<T>(ini.GetInt(SECTION_EXPLORER, key, static_cast<int>(defaultValue)));
 }
 
 template<typename T>
-void WriteEnum(const WCHAR* key, T value, const std::filesystem::path& iniPath) {
-    WriteInt(key, static_cast<int>(value), iniPath);
+void WriteEnum(const WCHAR* key, T value, IniDocument& ini) {
+    WriteInt(key, static_cast<int>(value), ini);
 }
 
 } // namespace
@@ -115,62 +115,55 @@ void Settings::Load(const std::filesystem::path& configDir)
     }
 
     _iniFilePath = _configPath / EXPLORER_INI;
-    if (!std::filesystem::exists(_iniFilePath)) {
-        HANDLE hFile = ::CreateFile(_iniFilePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
-        if (hFile != INVALID_HANDLE_VALUE) {
-            BYTE bom[] = {0xFF, 0xFE};
-            DWORD dwByteWritten = 0;
-            ::WriteFile(hFile, bom, sizeof(bom), &dwByteWritten, nullptr);
-            ::CloseHandle(hFile);
-        }
-    }
 
-    _currentDir = ReadString(LastPath, L"C:\\", _iniFilePath);
+    /* the file is read once, all values come from the parsed document */
+    IniDocument ini;
+    ini.Load(_iniFilePath);
+
+    _currentDir = ReadString(LastPath, L"C:\\", ini);
     _workspaceFolders.clear();
     for (int i = 0; i < 100; i++) {
-        std::wstring key = std::to_wstring(i);
-        WCHAR pszTemp[MAX_PATH];
-        if (::GetPrivateProfileString(SECTION_WORKSPACE_FOLDERS, key.c_str(), L"", pszTemp, MAX_PATH, _iniFilePath.c_str()) != 0) {
-            _workspaceFolders.emplace_back(pszTemp);
+        std::wstring folder = ini.GetString(SECTION_WORKSPACE_FOLDERS, std::to_wstring(i), L"");
+        if (!folder.empty()) {
+            _workspaceFolders.push_back(std::move(folder));
         }
     }
-    _iSplitterPos = ReadInt(SplitterPos, 120, _iniFilePath);
-    _iSplitterPosHorizontal = ReadInt(SplitterPosHor, 200, _iniFilePath);
-    _bAscending = ReadBool(SortAsc, true, _iniFilePath);
-    _iSortPos = ReadInt(SortPos, 0, _iniFilePath);
-    _iColumnPosName = ReadInt(ColPosName, 150, _iniFilePath);
-    _iColumnPosExt = ReadInt(ColPosExt, 50, _iniFilePath);
-    _iColumnPosSize = ReadInt(ColPosSize, 70, _iniFilePath);
-    _iColumnPosDate = ReadInt(ColPosDate, 100, _iniFilePath);
-    _bShowHidden = ReadBool(ShowHiddenData, false, _iniFilePath);
-    _bViewBraces = ReadBool(ShowBraces, true, _iniFilePath);
-    _bViewLong = ReadBool(ShowLongInfo, false, _iniFilePath);
-    _bAddExtToName = ReadBool(AddExtToName, false, _iniFilePath);
-    _bAutoUpdate = ReadBool(AutoUpdate, true, _iniFilePath);
-    _bAutoNavigate = ReadBool(AutoNavigate, false, _iniFilePath);
-    _bShowWorkspaceMode = ReadBool(ShowWorkspaceMode, false, _iniFilePath);
-    _bUseFullTree = ReadBool(UseFullTree, false, _iniFilePath);
-    _bHideFoldersInFileList = ReadBool(HideFolders, false, _iniFilePath);
-    _fmtSize = ReadEnum(SizeFormat, SizeFmt::SFMT_KBYTE, _iniFilePath);
-    _fmtDate = ReadEnum(DateFormat, DateFmt::DFMT_ENG, _iniFilePath);
-    _uTimeout = static_cast<UINT>(ReadInt(TimeOut, 1000, _iniFilePath));
-    _bUseSystemIcons = ReadBool(UseSystemIcons, true, _iniFilePath);
-    _bUseFluentIcons = ReadBool(UseFluentIcons, false, _iniFilePath);
-    _maxHistorySize = static_cast<size_t>(ReadInt(MaxHistorySize, 50, _iniFilePath));
+    _iSplitterPos = ReadInt(SplitterPos, 120, ini);
+    _iSplitterPosHorizontal = ReadInt(SplitterPosHor, 200, ini);
+    _bAscending = ReadBool(SortAsc, true, ini);
+    _iSortPos = ReadInt(SortPos, 0, ini);
+    _iColumnPosName = ReadInt(ColPosName, 150, ini);
+    _iColumnPosExt = ReadInt(ColPosExt, 50, ini);
+    _iColumnPosSize = ReadInt(ColPosSize, 70, ini);
+    _iColumnPosDate = ReadInt(ColPosDate, 100, ini);
+    _bShowHidden = ReadBool(ShowHiddenData, false, ini);
+    _bViewBraces = ReadBool(ShowBraces, true, ini);
+    _bViewLong = ReadBool(ShowLongInfo, false, ini);
+    _bAddExtToName = ReadBool(AddExtToName, false, ini);
+    _bAutoUpdate = ReadBool(AutoUpdate, true, ini);
+    _bAutoNavigate = ReadBool(AutoNavigate, false, ini);
+    _bShowWorkspaceMode = ReadBool(ShowWorkspaceMode, false, ini);
+    _bUseFullTree = ReadBool(UseFullTree, false, ini);
+    _bHideFoldersInFileList = ReadBool(HideFolders, false, ini);
+    _fmtSize = ReadEnum(SizeFormat, SizeFmt::SFMT_KBYTE, ini);
+    _fmtDate = ReadEnum(DateFormat, DateFmt::DFMT_ENG, ini);
+    _uTimeout = static_cast<UINT>(ReadInt(TimeOut, 1000, ini));
+    _bUseSystemIcons = ReadBool(UseSystemIcons, true, ini);
+    _bUseFluentIcons = ReadBool(UseFluentIcons, false, ini);
+    _maxHistorySize = static_cast<size_t>(ReadInt(MaxHistorySize, 50, ini));
     
-    _nppExecProp.szAppName = ReadString(NppExecAppName, L"NppExec.dll", _iniFilePath);
-    _nppExecProp.szScriptPath = ReadString(NppExecScriptPath, _configPath.c_str(), _iniFilePath);
-    _cphProgram.szAppName = ReadString(CphProgramName, L"cmd.exe", _iniFilePath);
+    _nppExecProp.szAppName = ReadString(NppExecAppName, L"NppExec.dll", ini);
+    _nppExecProp.szScriptPath = ReadString(NppExecScriptPath, _configPath.c_str(), ini);
+    _cphProgram.szAppName = ReadString(CphProgramName, L"cmd.exe", ini);
 
     _vStrFilterHistory.clear();
     for (int i = 0; i < 20; i++) {
-        std::wstring key = std::to_wstring(i);
-        WCHAR pszTemp[MAX_PATH];
-        if (::GetPrivateProfileString(SECTION_FILTER_HISTORY, key.c_str(), L"", pszTemp, MAX_PATH, _iniFilePath.c_str()) != 0) {
-            _vStrFilterHistory.emplace_back(pszTemp);
+        std::wstring filter = ini.GetString(SECTION_FILTER_HISTORY, std::to_wstring(i), L"");
+        if (!filter.empty()) {
+            _vStrFilterHistory.push_back(std::move(filter));
         }
     }
-    _fileFilter.setFilter(ReadString(LastFilter, L"*.*", _iniFilePath).c_str());
+    _fileFilter.setFilter(ReadString(LastFilter, L"*.*", ini).c_str());
 
     if (!std::filesystem::exists(_currentDir)) {
         _currentDir = L"C:\\";
@@ -179,16 +172,16 @@ void Settings::Load(const std::filesystem::path& configDir)
     // get default font
     ::SystemParametersInfo(SPI_GETICONTITLELOGFONT, sizeof(LOGFONT), &_logFont, 0);
 
-    int fontHeight = ReadInt(FontHeight, 0, _iniFilePath);
+    int fontHeight = ReadInt(FontHeight, 0, ini);
     if (fontHeight != 0) _logFont.lfHeight = fontHeight;
 
-    int fontWeight = ReadInt(FontWeight, 0, _iniFilePath);
+    int fontWeight = ReadInt(FontWeight, 0, ini);
     if (fontWeight != 0) _logFont.lfWeight = fontWeight;
 
-    int fontItalic = ReadInt(FontItalic, 0, _iniFilePath);
+    int fontItalic = ReadInt(FontItalic, 0, ini);
     if (fontItalic != 0) _logFont.lfItalic = TRUE;
 
-    std::wstring faceName = ReadString(FontFaceName, L"", _iniFilePath);
+    std::wstring faceName = ReadString(FontFaceName, L"", ini);
     if (!faceName.empty()) {
         wcsncpy(_logFont.lfFaceName, faceName.c_str(), LF_FACESIZE);
     }
@@ -196,49 +189,58 @@ void Settings::Load(const std::filesystem::path& configDir)
 
 void Settings::Save()
 {
-    WriteString(LastPath, _currentDir, _iniFilePath);
+    /* keys of other versions are kept, the file is written once */
+    IniDocument ini;
+    if (!ini.Load(_iniFilePath)) {
+        /* a file that cannot be read is kept rather than replaced by our keys alone */
+        return;
+    }
+
+    WriteString(LastPath, _currentDir, ini);
 
-    ::WritePrivateProfileString(SECTION_WORKSPACE_FOLDERS, nullptr, nullptr, _iniFilePath.c_str());
+    ini.ClearSection(SECTION_WORKSPACE_FOLDERS);
     for (size_t i = 0; i < _workspaceFolders.size(); ++i) {
-        ::WritePrivateProfileString(SECTION_WORKSPACE_FOLDERS, std::to_wstring(i).c_str(), _workspaceFolders[i].c_str(), _iniFilePath.c_str());
+        ini.SetString(SECTION_WORKSPACE_FOLDERS, std::to_wstring(i), _workspaceFolders[i]);
     }
-    WriteInt(SplitterPos, _iSplitterPos, _iniFilePath);
-    WriteInt(SplitterPosHor, _iSplitterPosHorizontal, _iniFilePath);
-    WriteBool(SortAsc, _bAscending, _iniFilePath);
-    WriteInt(SortPos, _iSortPos, _iniFilePath);
-    WriteInt(ColPosName, _iColumnPosName, _iniFilePath);
-    WriteInt(ColPosExt, _iColumnPosExt, _iniFilePath);
-    WriteInt(ColPosSize, _iColumnPosSize, _iniFilePath);
-    WriteInt(ColPosDate, _iColumnPosDate, _iniFilePath);
-    WriteBool(ShowHiddenData, _bShowHidden, _iniFilePath);
-    WriteBool(ShowBraces, _bViewBraces, _iniFilePath);
-    WriteBool(ShowLongInfo, _bViewLong, _iniFilePath);
-    WriteBool(AddExtToName, _bAddExtToName, _iniFilePath);
-    WriteBool(AutoUpdate, _bAutoUpdate, _iniFilePath);
-    WriteBool(AutoNavigate, _bAutoNavigate, _iniFilePath);
-    WriteBool(ShowWorkspaceMode, _bShowWorkspaceMode, _iniFilePath);
-    WriteBool(UseFullTree, _bUseFullTree, _iniFilePath);
-    WriteBool(HideFolders, _bHideFoldersInFileList, _iniFilePath);    
-    WriteEnum(SizeFormat, _fmtSize, _iniFilePath);
-    WriteEnum(DateFormat, _fmtDate, _iniFilePath);
-    WriteInt(TimeOut, static_cast<int>(_uTimeout), _iniFilePath);
-    WriteBool(UseSystemIcons, _bUseSystemIcons, _iniFilePath);
-    WriteBool(UseFluentIcons, _bUseFluentIcons, _iniFilePath);
-    WriteString(NppExecAppName, _nppExecProp.szAppName, _iniFilePath);
-    WriteString(NppExecScriptPath, _nppExecProp.szScriptPath, _iniFilePath);
-    WriteString(CphProgramName, _cphProgram.szAppName, _iniFilePath);
-    WriteInt(MaxHistorySize, static_cast<int>(_maxHistorySize), _iniFilePath);
-
-    WriteInt(FontHeight, _logFont.lfHeight, _iniFilePath);
-    WriteInt(FontWeight, _logFont.lfWeight, _iniFilePath);
-    WriteInt(FontItalic, _logFont.lfItalic, _iniFilePath);
-    WriteString(FontFaceName, _logFont.lfFaceName, _iniFilePath);
-
-    ::WritePrivateProfileString(SECTION_FILTER_HISTORY, nullptr, nullptr, _iniFilePath.c_str());
+    WriteInt(SplitterPos, _iSplitterPos, ini);
+    WriteInt(SplitterPosHor, _iSplitterPosHorizontal, ini);
+    WriteBool(SortAsc, _bAscending, ini);
+    WriteInt(SortPos, _iSortPos, ini);
+    WriteInt(ColPosName, _iColumnPosName, ini);
+    WriteInt(ColPosExt, _iColumnPosExt, ini);
+    WriteInt(ColPosSize, _iColumnPosSize, ini);
+    WriteInt(ColPosDate, _iColumnPosDate, ini);
+    WriteBool(ShowHiddenData, _bShowHidden, ini);
+    WriteBool(ShowBraces, _bViewBraces, ini);
+    WriteBool(ShowLongInfo, _bViewLong, ini);
+    WriteBool(AddExtToName, _bAddExtToName, ini);
+    WriteBool(AutoUpdate, _bAutoUpdate, ini);
+    WriteBool(AutoNavigate, _bAutoNavigate, ini);
+    WriteBool(ShowWorkspaceMode, _bShowWorkspaceMode, ini);
+    WriteBool(UseFullTree, _bUseFullTree, ini);
+    WriteBool(HideFolders, _bHideFoldersInFileList, ini);    
+    WriteEnum(SizeFormat, _fmtSize, ini);
+    WriteEnum(DateFormat, _fmtDate, ini);
+    WriteInt(TimeOut, static_cast<int>(_uTimeout), ini);
+    WriteBool(UseSystemIcons, _bUseSystemIcons, ini);
+    WriteBool(UseFluentIcons, _bUseFluentIcons, ini);
+    WriteString(NppExecAppName, _nppExecProp.szAppName, ini);
+    WriteString(NppExecScriptPath, _nppExecProp.szScriptPath, ini);
+    WriteString(CphProgramName, _cphProgram.szAppName, ini);
+    WriteInt(MaxHistorySize, static_cast<int>(_maxHistorySize), ini);
+
+    WriteInt(FontHeight, _logFont.lfHeight, ini);
+    WriteInt(FontWeight, _logFont.lfWeight, ini);
+    WriteInt(FontItalic, _logFont.lfItalic, ini);
+    WriteString(FontFaceName, _logFont.lfFaceName, ini);
+
+    ini.ClearSection(SECTION_FILTER_HISTORY);
     for (size_t i = 0; i < _vStrFilterHistory.size() && i < 20; ++i) {
-        ::WritePrivateProfileString(SECTION_FILTER_HISTORY, std::to_wstring(i).c_str(), _vStrFilterHistory[i].c_str(), _iniFilePath.c_str());
+        ini.SetString(SECTION_FILTER_HISTORY, std::to_wstring(i), _vStrFilterHistory[i]);
     }
-    WriteString(LastFilter, _fileFilter.getFilterString(), _iniFilePath);
+    WriteString(LastFilter, _fileFilter.getFilterString(), ini);
+
+    ini.Save(_iniFilePath);
 }
 
 void Settings::InitializeFonts()
@@ -258,22 +260,10 @@ bool Settings::IsPathInWorkspace(const std::wstring& path) const
     if (_workspaceFolders.empty()) {
         return true;
     }
-    std::wstring cleanPath = path;
-    if (!cleanPath.empty() && cleanPath.back() == L'\\') {
-        cleanPath.pop_back();
-    }
+    PathTable& pathTable = PathTable::Instance();
+    const PathId pathId = pathTable.Intern(path);
     for (const auto& w : _workspaceFolders) {
-        std::wstring cleanW = w;
-        if (!cleanW.empty() && cleanW.back() == L'\\') {
-            cleanW.pop_back();
-        }
-        
-        if (_wcsicmp(cleanPath.c_str(), cleanW.c_str()) == 0) {
-            return true;
-        }
-        
-        std::wstring prefix = cleanW + L'\\';
-        if (cleanPath.size() > prefix.size() && _wcsnicmp(cleanPath.c_str(), prefix.c_str(), prefix.size()) == 0) {
+        if (pathTable.IsSameOrDescendant(pathId, pathTable.Intern(w))) {
             return true;
         }
     }
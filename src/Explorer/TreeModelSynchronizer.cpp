@@ -23,6 +23,10 @@
 #include "TreeModelSynchronizer.h"
 
 #include <algorithm>
+#include <format>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <windows.h>
 
 #include "ExplorerDialog.h"
@@ -50,71 +54,255 @@ static HTREEITEM InsertChildFolderNode(
     return dialog.InsertChildFolder(entry, parentItem, insertAfter, isDirectory, isHidden, haveChildren);
 }
 
+/// Queue async icon extraction for a newly placed tree item.
+static void EnqueueIcon(
+    ExplorerDialog& dialog,
+    TreeView& treeCtrl,
+    HTREEITEM hItem,
+    DevType devType,
+    Settings* settings,
+    ExplorerViewModel& viewModel)
+{
+    std::wstring currentPath = dialog.GetPath(hItem);
+    if (devType == DEVT_DRIVE || settings->IsUseSystemIcons()) {
+        viewModel.FetchTreeViewIcons(&treeCtrl, hItem, currentPath, devType);
+    }
+}
+
+/// Store the binary collation key of the entry's name. Comparing keys
+/// bytewise orders names like CompareStringEx with the same flags.
+static void CollateName(const ExplorerEntry& entry)
+{
+    constexpr DWORD flags = LCMAP_SORTKEY | LINGUISTIC_IGNOREDIACRITIC | SORT_DIGITSASNUMBERS;
+    const std::wstring_view name = entry.Name();
+    const int length = static_cast<int>(name.size());
+
+    char stackKey[512];
+    int size = ::LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, name.data(), length, reinterpret_cast<LPWSTR>(stackKey), sizeof(stackKey), nullptr, nullptr, 0);
+    if (size > 0) {
+        entry.SetSortKey({ stackKey, static_cast<size_t>(size) });
+        return;
+    }
+
+    size = ::LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, name.data(), length, nullptr, 0, nullptr, nullptr, 0);
+    if (size > 0) {
+        std::string key(static_cast<size_t>(size), '\0');
+        ::LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, name.data(), length, reinterpret_cast<LPWSTR>(key.data()), size, nullptr, nullptr, 0);
+        entry.SetSortKey(key);
+    }
+}
+
+/// Whether @p name contains @p text, ignoring case.
+static bool ContainsName(std::wstring_view name, std::wstring_view text)
+{
+    return ::FindNLSStringEx(LOCALE_NAME_USER_DEFAULT, FIND_FROMSTART | LINGUISTIC_IGNORECASE,
+        name.data(), static_cast<int>(name.size()), text.data(), static_cast<int>(text.size()),
+        nullptr, nullptr, nullptr, 0) >= 0;
+}
+
+static size_t SynchronizeChildren(
+    ExplorerDialog& dialog,
+    TreeView& treeCtrl,
+    HTREEITEM hParentItem,
+    const std::shared_ptr<ExplorerEntry>& entry,
+    Settings* settings,
+    ExplorerViewModel& viewModel,
+    size_t childLimit,
+    std::wstring_view childFilter,
+    bool suspendRedraw);
+
+/// Rebuild the expanded subtree of a moved item under the item that replaces
+/// it. The entries already hold the loaded children, so no folder is read again.
+static void CopySubtree(
+    ExplorerDialog& dialog,
+    TreeView& treeCtrl,
+    HTREEITEM hOldItem,
+    HTREEITEM hNewItem,
+    Settings* settings,
+    ExplorerViewModel& viewModel)
+{
+    auto* pNew = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hNewItem));
+    if (!treeCtrl.IsItemExpanded(hOldItem) || pNew == nullptr || *pNew == nullptr || !(*pNew)->HasLoadedChildren()) {
+        return;
+    }
+    SynchronizeChildren(dialog, treeCtrl, hNewItem, *pNew, settings, viewModel, TreeModelSynchronizer::PAGE_SIZE, {}, false);
+
+    std::unordered_map<std::wstring_view, HTREEITEM> newByName;
+    for (HTREEITEM hChild = treeCtrl.GetChild(hNewItem); hChild != nullptr; hChild = treeCtrl.GetNextItem(hChild, TVGN_NEXT)) {
+        auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hChild));
+        if (pShared != nullptr && *pShared != nullptr) {
+            newByName.emplace((*pShared)->Name(), hChild);
+        }
+    }
+    for (HTREEITEM hChild = treeCtrl.GetChild(hOldItem); hChild != nullptr; hChild = treeCtrl.GetNextItem(hChild, TVGN_NEXT)) {
+        auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hChild));
+        if (pShared == nullptr || *pShared == nullptr || !treeCtrl.IsItemExpanded(hChild)) {
+            continue;
+        }
+        auto found = newByName.find((*pShared)->Name());
+        if (found != newByName.end()) {
+            CopySubtree(dialog, treeCtrl, hChild, found->second, settings, viewModel);
+        }
+    }
+    treeCtrl.SetItemExpanded(hNewItem, TRUE);
+}
+
 // ---------------------------------------------------------------------------
 // TreeModelSynchronizer::Synchronize
 // ---------------------------------------------------------------------------
 
-void TreeModelSynchronizer::Synchronize(
+size_t TreeModelSynchronizer::Synchronize(
     ExplorerDialog& dialog,
     TreeView& treeCtrl,
     HTREEITEM hParentItem,
     const std::shared_ptr<ExplorerEntry>& entry,
     Settings* settings,
-    ExplorerViewModel& viewModel)
+    ExplorerViewModel& viewModel,
+    size_t childLimit,
+    std::wstring_view childFilter)
 {
-    if (FileSystemService::IsUncServerPath(dialog.GetPath(hParentItem))) {
+    return SynchronizeChildren(dialog, treeCtrl, hParentItem, entry, settings, viewModel, childLimit, childFilter, true);
+}
+
+static size_t SynchronizeChildren(
+    ExplorerDialog& dialog,
+    TreeView& treeCtrl,
+    HTREEITEM hParentItem,
+    const std::shared_ptr<ExplorerEntry>& entry,
+    Settings* settings,
+    ExplorerViewModel& viewModel,
+    size_t childLimit,
+    std::wstring_view childFilter,
+    bool suspendRedraw)
+{
+    const std::wstring parentPath = dialog.GetPath(hParentItem);
+    if (FileSystemService::IsUncServerPath(parentPath)) {
         treeCtrl.SetItemHasChildren(hParentItem, TRUE);
-        return;
+        return 0;
     }
 
-    HTREEITEM hCurrentChild = treeCtrl.GetNextItem(hParentItem, TVGN_CHILD);
+    // --- Snapshot of the current children ---
+    // Names come from the entries held by the items. The only item without an
+    // entry is the "more" item, which is kept apart. Holding the entries keeps
+    // the name views valid while the items are re-pointed to the new entries below.
+    struct TreeChild {
+        HTREEITEM hItem;
+        std::shared_ptr<ExplorerEntry> entry;
+        bool isKept = false;
+    };
+    std::vector<TreeChild> current;
+    HTREEITEM hMoreItem = nullptr;
+    for (HTREEITEM hChild = treeCtrl.GetChild(hParentItem); hChild != nullptr; hChild = treeCtrl.GetNextItem(hChild, TVGN_NEXT)) {
+        auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hChild));
+        if (pShared != nullptr && *pShared != nullptr) {
+            current.push_back({ hChild, *pShared });
+        } else {
+            hMoreItem = hChild;
+        }
+    }
+
+    std::unordered_map<std::wstring_view, size_t> currentByName;
+    currentByName.reserve(current.size());
+    for (size_t i = 0; i < current.size(); ++i) {
+        currentByName.emplace(current[i].entry->Name(), i);
+    }
+
+    // --- Sort keys ---
+    // Children are ordered folders first, each group by collation key. Keys
+    // are cached on the entries, and unchanged names take the key of the
+    // entry their item held, so only new names are collated.
+    auto byKey = [](const std::shared_ptr<ExplorerEntry>& lhs, const std::shared_ptr<ExplorerEntry>& rhs) {
+        return lhs->SortKey() < rhs->SortKey();
+    };
+    auto isDirectory = [](const std::shared_ptr<ExplorerEntry>& child) {
+        return child->IsDirectory();
+    };
 
     auto children = entry->Children();
+    bool isReordered = false;
+    if (!std::is_partitioned(children.begin(), children.end(), isDirectory)) {
+        std::stable_partition(children.begin(), children.end(), isDirectory);
+        isReordered = true;
+    }
+    const auto firstFile = std::partition_point(children.begin(), children.end(), isDirectory);
+
+    auto sortByKey = [&](auto first, auto last) {
+        for (auto it = first; it != last; ++it) {
+            const auto& child = *it;
+            if (!child->SortKey().empty()) {
+                continue;
+            }
+            auto found = currentByName.find(child->Name());
+            if (found != currentByName.end() && !current[found->second].entry->SortKey().empty()) {
+                child->SetSortKey(current[found->second].entry->SortKey());
+            } else {
+                CollateName(*child);
+            }
+        }
+        if (!std::is_sorted(first, last, byKey)) {
+            std::sort(first, last, byKey);
+            isReordered = true;
+        }
+    };
+    sortByKey(children.begin(), firstFile);
+    if (settings->IsUseFullTree()) {
+        sortByKey(firstFile, children.end());
+    }
 
-    // Split children into folders and (optionally) files
+    // The model keeps the sorted order, so re-syncing unchanged children
+    // only verifies it
+    if (isReordered) {
+        entry->SetChildren(children);
+    }
+
+    // Split children into folders and (optionally) files; folders excluded
+    // by the filter are not shown, so their trees are never read
+    const FileFilter& filter = settings->GetFileFilter();
     std::vector<std::shared_ptr<ExplorerEntry>> folders;
+    for (auto it = children.begin(); it != firstFile; ++it) {
+        if (!filter.isExcludedDirectory(parentPath, (*it)->Name())) {
+            folders.push_back(*it);
+        }
+    }
     std::vector<std::shared_ptr<ExplorerEntry>> files;
-
-    for (const auto& child : children) {
-        if (child->FSEntry().IsDirectory()) {
-            folders.push_back(child);
-        } else if (settings->IsUseFullTree()) {
-            if (settings->GetFileFilter().match(child->FSEntry().Name())) {
-                files.push_back(child);
+    if (settings->IsUseFullTree()) {
+        for (auto it = firstFile; it != children.end(); ++it) {
+            if (filter.match(parentPath, (*it)->Name())) {
+                files.push_back(*it);
             }
         }
     }
 
-    // Sort both lists by locale-aware name so the diff is deterministic
-    auto byName = [](const std::shared_ptr<ExplorerEntry>& lhs, const std::shared_ptr<ExplorerEntry>& rhs) {
-        int result = ::CompareStringEx(
-            LOCALE_NAME_USER_DEFAULT,
-            LINGUISTIC_IGNOREDIACRITIC | SORT_DIGITSASNUMBERS,
-            lhs->FSEntry().Name().c_str(), -1,
-            rhs->FSEntry().Name().c_str(), -1,
-            NULL, NULL, 0
-        );
-        return result == CSTR_LESS_THAN;
-    };
-    std::sort(folders.begin(), folders.end(), byName);
-    std::sort(files.begin(),   files.end(),   byName);
+    // The name filter of the node narrows both groups before they are paged
+    if (!childFilter.empty()) {
+        auto isFilteredOut = [childFilter](const std::shared_ptr<ExplorerEntry>& child) {
+            return !ContainsName(child->Name(), childFilter);
+        };
+        std::erase_if(folders, isFilteredOut);
+        std::erase_if(files, isFilteredOut);
+    }
 
     DevType devType = (hParentItem == TVI_ROOT ? DEVT_DRIVE : DEVT_DIRECTORY);
 
     // Helper: enqueue async icon extraction for a newly placed tree item
     auto enqueueIcon = [&](HTREEITEM hItem) {
-        std::wstring currentPath = dialog.GetPath(hItem);
-        if (devType == DEVT_DRIVE || settings->IsUseSystemIcons()) {
-            viewModel.FetchTreeViewIcons(&treeCtrl, hItem, currentPath, devType);
+        EnqueueIcon(dialog, treeCtrl, hItem, devType, settings, viewModel);
+    };
+
+    // Helper: carry the loaded children and probe state of an item's entry over to its new entry
+    auto inheritState = [](const std::shared_ptr<ExplorerEntry>& oldEntry, const std::shared_ptr<ExplorerEntry>& childEntry) {
+        if (oldEntry->HasLoadedChildren()) {
+            childEntry->SetChildren(oldEntry->Children());
         }
+        childEntry->CopyProbeState(*oldEntry);
     };
 
     // Helper: update an existing tree item's data and schedule icon refresh
     auto updateExistingItem = [&](HTREEITEM hItem, const std::shared_ptr<ExplorerEntry>& childEntry) {
         auto* pOld = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hItem));
         if (pOld != nullptr) {
-            if (*pOld != nullptr && (*pOld)->HasLoadedChildren()) {
-                childEntry->SetChildren((*pOld)->Children());
+            if (*pOld != nullptr) {
+                inheritState(*pOld, childEntry);
             }
             *pOld = childEntry;
         }
@@ -122,67 +310,270 @@ void TreeModelSynchronizer::Synchronize(
         enqueueIcon(hItem);
     };
 
-    // --- In-order diff loop ---
-    // Walk model entries (sorted) and current tree children (also sorted) in parallel.
-    // For each model entry either:
-    //   * the tree already has it  -> update in place, advance both iterators
-    //   * the tree has a different entry that sorts *after* -> insert before it
-    //   * the tree has a different entry that sorts *before* -> delete it
-
-    for (const auto* entries_ptr : { &folders, &files }) {
-        for (const auto& childEntry : *entries_ptr) {
-            std::wstring name = treeCtrl.GetItemText(hCurrentChild);
-            if (!name.empty()) {
-                // While the current tree child does not match the model entry ...
-                while ((name != childEntry->FSEntry().Name()) && (hCurrentChild != nullptr)) {
-                    // Check whether the wanted entry appears further down the tree
-                    if (dialog.FindFolderAfter(childEntry->FSEntry().Name().c_str(), hCurrentChild) == TRUE) {
-                        // Delete the stale (now-removed) child and advance
-                        HTREEITEM pPrevItem = hCurrentChild;
-                        hCurrentChild = treeCtrl.GetNextItem(hCurrentChild, TVGN_NEXT);
-                        treeCtrl.DeleteItem(pPrevItem);
-                    } else {
-                        // The entry is new - insert it before the current child
-                        HTREEITEM pPrevItem = treeCtrl.GetNextItem(hCurrentChild, TVGN_PREVIOUS);
-                        if (pPrevItem == nullptr) {
-                            hCurrentChild = InsertChildFolderNode(dialog, treeCtrl, childEntry, hParentItem, TVI_FIRST,
-                                childEntry->FSEntry().IsDirectory(), childEntry->FSEntry().IsHidden(), childEntry->FSEntry().IsDirectory());
-                        } else {
-                            hCurrentChild = InsertChildFolderNode(dialog, treeCtrl, childEntry, hParentItem, pPrevItem,
-                                childEntry->FSEntry().IsDirectory(), childEntry->FSEntry().IsHidden(), childEntry->FSEntry().IsDirectory());
-                        }
-                    }
-
-                    if (hCurrentChild != nullptr) {
-                        name = treeCtrl.GetItemText(hCurrentChild);
-                    }
-                }
+    // --- Edit script ---
+    // The items kept in place are the longest run of existing items that is
+    // already in model order: the longest increasing subsequence of their
+    // current positions, found in O(n log n). Every other model entry is
+    // inserted after its predecessor and every item not kept is deleted. An
+    // item that only moved hands its state and expanded subtree to its new item.
+    std::vector<const std::shared_ptr<ExplorerEntry>*> desired;
+    desired.reserve(folders.size() + files.size());
+    for (const auto& child : folders) {
+        desired.push_back(&child);
+    }
+    for (const auto& child : files) {
+        desired.push_back(&child);
+    }
 
-                // Names match: update the existing item
-                updateExistingItem(hCurrentChild, childEntry);
-                hCurrentChild = treeCtrl.GetNextItem(hCurrentChild, TVGN_NEXT);
+    // Only the first page(s) go into the control; huge folders would block the UI
+    size_t hiddenCount = 0;
+    if (desired.size() > childLimit) {
+        hiddenCount = desired.size() - childLimit;
+        desired.resize(childLimit);
+    }
 
-            } else {
-                // No more existing children - simply append
-                hCurrentChild = InsertChildFolderNode(dialog, treeCtrl, childEntry, hParentItem, TVI_LAST,
-                    childEntry->FSEntry().IsDirectory(), childEntry->FSEntry().IsHidden(), childEntry->FSEntry().IsDirectory());
-                enqueueIcon(hCurrentChild);
-                hCurrentChild = treeCtrl.GetNextItem(hCurrentChild, TVGN_NEXT);
+    constexpr size_t NOT_KEPT = SIZE_MAX;
+    std::vector<size_t> currentIndex(desired.size(), NOT_KEPT);
+    std::vector<size_t> matched;    // desired indices that have an item
+    for (size_t i = 0; i < desired.size(); ++i) {
+        auto found = currentByName.find((*desired[i])->Name());
+        if (found != currentByName.end()) {
+            currentIndex[i] = found->second;
+            matched.push_back(i);
+        }
+    }
+
+    // tails[k]: the match ending the best increasing run of length k + 1 found so far
+    std::vector<size_t> tails;
+    std::vector<size_t> previous(matched.size(), NOT_KEPT);
+    for (size_t m = 0; m < matched.size(); ++m) {
+        const size_t position = currentIndex[matched[m]];
+        auto tail = std::lower_bound(tails.begin(), tails.end(), position, [&](size_t t, size_t value) {
+            return currentIndex[matched[t]] < value;
+        });
+        if (tail != tails.begin()) {
+            previous[m] = *(tail - 1);
+        }
+        if (tail == tails.end()) {
+            tails.push_back(m);
+        } else {
+            *tail = m;
+        }
+    }
+
+    std::vector<bool> isKept(desired.size(), false);
+    size_t keptCount = 0;
+    for (size_t m = tails.empty() ? NOT_KEPT : tails.back(); m != NOT_KEPT; m = previous[m]) {
+        isKept[matched[m]] = true;
+        current[currentIndex[matched[m]]].isKept = true;
+        keptCount++;
+    }
+
+    const bool hasMoreItem = (hiddenCount != 0) || !childFilter.empty();
+    const bool isStructureChanged = (keptCount != desired.size()) || (keptCount != current.size()) || (hasMoreItem != (hMoreItem != nullptr));
+
+    // --- Apply the script ---
+    // Painting is suspended only when items are inserted or deleted.
+    const bool isRedrawSuspended = suspendRedraw && isStructureChanged;
+    if (isRedrawSuspended) {
+        ::SendMessage(treeCtrl, WM_SETREDRAW, FALSE, 0);
+    }
+
+    struct MovedItem {
+        HTREEITEM hOldItem;
+        HTREEITEM hNewItem;
+    };
+    std::vector<MovedItem> moved;
+    HTREEITEM hPrevItem = TVI_FIRST;
+    for (size_t i = 0; i < desired.size(); ++i) {
+        const auto& childEntry = *desired[i];
+        if (isKept[i]) {
+            hPrevItem = current[currentIndex[i]].hItem;
+            updateExistingItem(hPrevItem, childEntry);
+        } else {
+            if (currentIndex[i] != NOT_KEPT) {
+                inheritState(current[currentIndex[i]].entry, childEntry);
+            }
+            HTREEITEM hItem = InsertChildFolderNode(dialog, treeCtrl, childEntry, hParentItem, hPrevItem,
+                childEntry->IsDirectory(), childEntry->IsHidden(), childEntry->IsDirectory());
+            if (hItem != nullptr) {
+                hPrevItem = hItem;
+                enqueueIcon(hItem);
+                if (currentIndex[i] != NOT_KEPT) {
+                    moved.push_back({ current[currentIndex[i]].hItem, hItem });
+                }
             }
         }
     }
 
-    // Delete any remaining stale children that are past the end of the model list
-    while (hCurrentChild != nullptr) {
-        HTREEITEM pPrevItem = hCurrentChild;
-        hCurrentChild = treeCtrl.GetNextItem(hCurrentChild, TVGN_NEXT);
-        treeCtrl.DeleteItem(pPrevItem);
+    // The old items are deleted once their subtrees are copied
+    for (const auto& item : moved) {
+        CopySubtree(dialog, treeCtrl, item.hOldItem, item.hNewItem, settings, viewModel);
+    }
+    for (const auto& child : current) {
+        if (!child.isKept) {
+            treeCtrl.DeleteItem(child.hItem);
+        }
+    }
+
+    // The "more" item stays last, new items are inserted after their predecessor.
+    // Its label is also where the name filter is edited, so it stays while one is set.
+    if (hasMoreItem) {
+        std::wstring moreText;
+        if (childFilter.empty()) {
+            moreText = std::format(L"{} more... (Ctrl+F to filter)", hiddenCount);
+        } else if (hiddenCount != 0) {
+            moreText = std::format(L"{} more matching \"{}\"...", hiddenCount, childFilter);
+        } else {
+            moreText = std::format(L"Filter: \"{}\"", childFilter);
+        }
+        if (hMoreItem != nullptr) {
+            treeCtrl.SetItemText(hMoreItem, moreText);
+        } else {
+            treeCtrl.InsertItem(moreText, ICON_FOLDER, ICON_FOLDER, 0, FALSE, hParentItem, TVI_LAST);
+        }
+    } else if (hMoreItem != nullptr) {
+        treeCtrl.DeleteItem(hMoreItem);
+    }
+
+    if (isRedrawSuspended) {
+        ::SendMessage(treeCtrl, WM_SETREDRAW, TRUE, 0);
+        ::InvalidateRect(treeCtrl, nullptr, TRUE);
     }
 
     // Update the parent's "has children" indicator
-    if (FileSystemService::IsUncServerPath(dialog.GetPath(hParentItem))) {
+    if (FileSystemService::IsUncServerPath(parentPath)) {
         treeCtrl.SetItemHasChildren(hParentItem, TRUE);
     } else {
         treeCtrl.SetItemHasChildren(hParentItem, treeCtrl.GetChild(hParentItem) != nullptr);
     }
+    return hiddenCount;
+}
+
+// ---------------------------------------------------------------------------
+// TreeModelSynchronizer::Refilter
+// ---------------------------------------------------------------------------
+
+size_t TreeModelSynchronizer::Refilter(
+    ExplorerDialog& dialog,
+    TreeView& treeCtrl,
+    HTREEITEM hParentItem,
+    const std::shared_ptr<ExplorerEntry>& entry,
+    Settings* settings,
+    ExplorerViewModel& viewModel,
+    size_t childLimit,
+    std::wstring_view childFilter)
+{
+    const std::wstring parentPath = dialog.GetPath(hParentItem);
+    if (FileSystemService::IsUncServerPath(parentPath)) {
+        return 0;
+    }
+
+    // Synchronize leaves the children folders first and sorted by key; a
+    // node in any other state, or one that is paged or filtered by name, gets a full sync.
+    auto isDirectory = [](const std::shared_ptr<ExplorerEntry>& child) {
+        return child->IsDirectory();
+    };
+    auto byKey = [](const std::shared_ptr<ExplorerEntry>& lhs, const std::shared_ptr<ExplorerEntry>& rhs) {
+        return lhs->SortKey() < rhs->SortKey();
+    };
+    auto children = entry->Children();
+    const auto firstFile = std::partition_point(children.begin(), children.end(), isDirectory);
+    const bool isInOrder = std::is_partitioned(children.begin(), children.end(), isDirectory)
+        && (!settings->IsUseFullTree()
+            || (std::none_of(firstFile, children.end(), [](const auto& child) { return child->SortKey().empty(); })
+                && std::is_sorted(firstFile, children.end(), byKey)));
+    if (!isInOrder || children.size() > childLimit || !childFilter.empty()) {
+        return Synchronize(dialog, treeCtrl, hParentItem, entry, settings, viewModel, childLimit, childFilter);
+    }
+
+    // The folder items are the folders the filter does not exclude, in the
+    // same order; if that set changed, the node gets a full sync
+    const FileFilter& filter = settings->GetFileFilter();
+    auto folder = children.begin();
+    auto skipExcludedFolders = [&]() {
+        while (folder != firstFile && filter.isExcludedDirectory(parentPath, (*folder)->Name())) {
+            ++folder;
+        }
+    };
+
+    // The file items follow the folder items
+    HTREEITEM hPrevItem = TVI_FIRST;
+    HTREEITEM hItem = treeCtrl.GetChild(hParentItem);
+    while (hItem != nullptr) {
+        auto* pShared = reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hItem));
+        if (pShared == nullptr || *pShared == nullptr) {
+            return Synchronize(dialog, treeCtrl, hParentItem, entry, settings, viewModel, childLimit, childFilter);
+        }
+        if (!(*pShared)->IsDirectory()) {
+            break;
+        }
+        skipExcludedFolders();
+        if (folder == firstFile || (*folder)->Name() != (*pShared)->Name()) {
+            return Synchronize(dialog, treeCtrl, hParentItem, entry, settings, viewModel, childLimit, childFilter);
+        }
+        ++folder;
+        hPrevItem = hItem;
+        hItem = treeCtrl.GetNextItem(hItem, TVGN_NEXT);
+    }
+    skipExcludedFolders();
+    if (folder != firstFile) {
+        return Synchronize(dialog, treeCtrl, hParentItem, entry, settings, viewModel, childLimit, childFilter);
+    }
+
+    // Without the full tree only the folders are shown
+    if (!settings->IsUseFullTree()) {
+        return 0;
+    }
+
+    // Painting is suspended from the first item that appears or disappears
+    bool isChanged = false;
+    auto beginChange = [&]() {
+        if (!isChanged) {
+            ::SendMessage(treeCtrl, WM_SETREDRAW, FALSE, 0);
+            isChanged = true;
+        }
+    };
+
+    // The file items are the matching files in the same order, so one walk
+    // over both finds every item whose visibility flipped
+    for (auto it = firstFile; it != children.end(); ++it) {
+        const auto& child = *it;
+        auto* pShared = (hItem != nullptr) ? reinterpret_cast<std::shared_ptr<ExplorerEntry>*>(treeCtrl.GetParam(hItem)) : nullptr;
+        const bool isShown = (pShared != nullptr && *pShared != nullptr && (*pShared == child || (*pShared)->Name() == child->Name()));
+        const bool isMatched = filter.match(parentPath, child->Name());
+
+        if (isShown) {
+            HTREEITEM hNextItem = treeCtrl.GetNextItem(hItem, TVGN_NEXT);
+            if (isMatched) {
+                hPrevItem = hItem;
+            } else {
+                beginChange();
+                treeCtrl.DeleteItem(hItem);
+            }
+            hItem = hNextItem;
+        } else if (isMatched) {
+            beginChange();
+            HTREEITEM hNewItem = InsertChildFolderNode(dialog, treeCtrl, child, hParentItem, hPrevItem, FALSE, child->IsHidden(), FALSE);
+            if (hNewItem != nullptr) {
+                hPrevItem = hNewItem;
+                EnqueueIcon(dialog, treeCtrl, hNewItem, DEVT_DIRECTORY, settings, viewModel);
+            }
+        }
+    }
+
+    // Items left over belong to files the entry no longer has
+    while (hItem != nullptr) {
+        beginChange();
+        HTREEITEM hStaleItem = hItem;
+        hItem = treeCtrl.GetNextItem(hItem, TVGN_NEXT);
+        treeCtrl.DeleteItem(hStaleItem);
+    }
+
+    if (isChanged) {
+        ::SendMessage(treeCtrl, WM_SETREDRAW, TRUE, 0);
+        ::InvalidateRect(treeCtrl, nullptr, TRUE);
+        treeCtrl.SetItemHasChildren(hParentItem, treeCtrl.GetChild(hParentItem) != nullptr);
+    }
+    return 0;
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include <vector>
 #include <windows.h>
 #include <commctrl.h>
@@ -47,12 +48,16 @@ class TreeModelSynchronizer {
 public:
     TreeModelSynchronizer() = delete;
 
+    /// @brief Number of children a node shows before a "more" item pages in the rest.
+    static constexpr size_t PAGE_SIZE = 500;
+
     /// @brief Synchronize the children of @p hParentItem in @p treeCtrl with the
     ///        children stored in @p entry.
     ///
-    /// The algorithm is an in-order diff: it walks the existing HTREEITEM
-    /// children and the sorted model children side-by-side, inserting missing
-    /// items, deleting removed items, and updating unchanged items.
+    /// The current children are snapshotted into a name->HTREEITEM hash once.
+    /// The longest run of items already in order stays in place, found in
+    /// O(n log n); moved items are re-inserted with their expanded subtrees.
+    /// The script is applied with painting suspended when items are added or removed.
     ///
     /// @param dialog       Back-pointer used to resolve paths from HTREEITEMs
     ///                     and to post async icon-extraction tasks.
@@ -62,12 +67,36 @@ public:
     ///                     desired state of the tree node.
     /// @param settings     Plugin settings (hidden-files, full-tree mode, etc.).
     /// @param viewModel    ExplorerViewModel used to dispatch icon-extraction tasks.
-    static void Synchronize(
+    /// @param childLimit   Children beyond this count are not inserted; a "more"
+    ///                     item without an lParam stands in for them.
+    /// @param childFilter  Only children whose name contains this text, ignoring
+    ///                     case, are shown. The "more" item stays while it is set.
+    /// @return The number of children left out by @p childLimit.
+    static size_t Synchronize(
+        ExplorerDialog& dialog,
+        TreeView& treeCtrl,
+        HTREEITEM hParentItem,
+        const std::shared_ptr<ExplorerEntry>& entry,
+        Settings* settings,
+        ExplorerViewModel& viewModel,
+        size_t childLimit,
+        std::wstring_view childFilter);
+
+    /// @brief Re-apply the file filter to the children of @p hParentItem.
+    ///
+    /// Only file visibility depends on the filter, so the sorted file children
+    /// are walked once next to the file items: items whose file no longer
+    /// matches are deleted and newly matching files are inserted in place.
+    /// Falls back to Synchronize when the node is paged, filtered by name or
+    /// not in sorted order. The parameters and result are the same as for Synchronize.
+    static size_t Refilter(
         ExplorerDialog& dialog,
         TreeView& treeCtrl,
         HTREEITEM hParentItem,
         const std::shared_ptr<ExplorerEntry>& entry,
         Settings* settings,
-        ExplorerViewModel& viewModel);
+        ExplorerViewModel& viewModel,
+        size_t childLimit,
+        std::wstring_view childFilter);
 };
 
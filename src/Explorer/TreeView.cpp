@@ -274,6 +274,12 @@ BOOL TreeView::IsItemExpanded(HTREEITEM hItem) const
     return (BOOL)(TreeView_GetItemState(_wnd, hItem, TVIS_EXPANDED) & TVIS_EXPANDED);
 }
 
+/* sets the state only, no TVN_ITEMEXPANDING is sent and the children must already exist */
+void TreeView::SetItemExpanded(HTREEITEM hItem, BOOL expanded)
+{
+    TreeView_SetItemState(_wnd, hItem, expanded ? TVIS_EXPANDED : 0, TVIS_EXPANDED);
+}
+
 INT TreeView::GetChildrenCount(HTREEITEM item) const
 {
     INT count = 0;
@@ -414,3 +420,13 @@ BOOL TreeView::SelectDropTarget(HTREEITEM item)
 {
     return TreeView_SelectDropTarget(_wnd, item);
 }
+
+HWND TreeView::EditLabel(HTREEITEM item)
+{
+    return TreeView_EditLabel(_wnd, item);
+}
+
+HWND TreeView::GetEditControl() const
+{
+    return TreeView_GetEditControl(_wnd);
+}
@@ -46,6 +46,7 @@ public:
     BOOL GetItemIcons(HTREEITEM hItem, LPINT iIcon, LPINT piSelected, LPINT iOverlay) const;
     void SetItemIcons(HTREEITEM hItem, INT icon, INT selected, INT overlay);
     BOOL IsItemExpanded(HTREEITEM hItem) const;
+    void SetItemExpanded(HTREEITEM hItem, BOOL expanded);
     INT GetChildrenCount(HTREEITEM item) const;
     std::vector<std::wstring> GetItemPathFromRoot(HTREEITEM currentItem) const;
     HTREEITEM FindTreeItemByParam(const void* param);
@@ -66,6 +67,8 @@ public:
     BOOL DeleteItem(HTREEITEM item);
     BOOL EnsureVisible(HTREEITEM item);
     BOOL SelectDropTarget(HTREEITEM item);
+    HWND EditLabel(HTREEITEM item);
+    HWND GetEditControl() const;
 protected:
     HWND    _wnd{nullptr};
 };
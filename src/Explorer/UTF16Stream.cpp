@@ -1,97 +1,65 @@
 #include "UTF16Stream.h"
+#include <bit>
 #include <stdexcept>
+#include <windows.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UTF16STREAM_SSE2
+#endif
 
 namespace {
 constexpr wchar_t UTF16LE_BOM = L'\xFEFF';
 
-std::wstring ConvertUtf8ToUtf16(std::string_view utf8_str)
-{
-    if (utf8_str.empty()) {
-        return {};
-    }
-
-    std::wstring result;
-    size_t i = 0;
-
-    while (i < utf8_str.length()) {
-        uint32_t codepoint = 0;
-        size_t bytes = 0;
-
-        unsigned char c = static_cast<unsigned char>(utf8_str[i]);
-
-        if (c < 0x80) {
-            codepoint = c;
-            bytes = 1;
-        }
-        else if ((c & 0xE0) == 0xC0) {
-            codepoint = c & 0x1F;
-            bytes = 2;
-        }
-        else if ((c & 0xF0) == 0xE0) {
-            codepoint = c & 0x0F;
-            bytes = 3;
-        }
-        else if ((c & 0xF8) == 0xF0) {
-            codepoint = c & 0x07;
-            bytes = 4;
-        }
-        else {
-            // Invalid UTF-8 sequence - skip this byte
-            ++i;
-            continue;
-        }
-
-        // Process remaining bytes
-        bool valid = true;
-        for (size_t j = 1; j < bytes && (i + j) < utf8_str.length(); ++j) {
-            unsigned char next = static_cast<unsigned char>(utf8_str[i + j]);
-            if ((next & 0xC0) != 0x80) {
-                // Invalid continuation byte
-                valid = false;
-                break;
+// Index of the first CR or LF at or after begin, or size if there is none
+size_t FindLineBreak(const wchar_t* data, size_t begin, size_t size)
+{
+#ifdef UTF16STREAM_SSE2
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m128i cr = _mm_set1_epi16(L'\r');
+        const __m128i lf = _mm_set1_epi16(L'\n');
+        for (; begin + 8 <= size; begin += 8) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + begin));
+            const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(chunk, cr), _mm_cmpeq_epi16(chunk, lf)));
+            if (mask != 0) {
+                return begin + std::countr_zero(static_cast<unsigned int>(mask)) / 2;
             }
-            codepoint = (codepoint << 6) | (next & 0x3F);
-        }
-
-        if (!valid || (i + bytes) > utf8_str.length()) {
-            // Skip invalid sequence
-            ++i;
-            continue;
-        }
-
-        // Convert to UTF-16
-        if (codepoint <= 0xFFFF) {
-            // Character in BMP
-            result += static_cast<wchar_t>(codepoint);
         }
-        else if (codepoint <= 0x10FFFF) {
-            // Surrogate pair required
-            codepoint -= 0x10000;
-            result += static_cast<wchar_t>(0xD800 + (codepoint >> 10));
-            result += static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+    }
+#endif
+    for (; begin < size; ++begin) {
+        if (data[begin] == L'\r' || data[begin] == L'\n') {
+            return begin;
         }
-
-        i += bytes;
     }
+    return size;
+}
 
-    return result;
+bool WriteAll(HANDLE file, const void* data, size_t size)
+{
+    DWORD written = 0;
+    return ::WriteFile(file, data, static_cast<DWORD>(size), &written, nullptr) && written == size;
 }
 
 } // namespace
 
 
 Utf16Reader::Utf16Reader(const std::filesystem::path& filename)
-    : file_(filename, std::ios::binary)
 {
-    if (!file_.is_open()) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
         throw std::runtime_error("Failed to open file: " + filename.string());
     }
 
-    wchar_t bom;
-    ReadChar(bom);
-    if (bom != UTF16LE_BOM) {
-        file_.clear();
-        file_.seekg(0, std::ios::beg);
+    // One read for the whole file; a trailing odd byte is dropped
+    const std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    buffer_.resize(static_cast<size_t>(size) / sizeof(wchar_t));
+    file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size() * sizeof(wchar_t)));
+    buffer_.resize(static_cast<size_t>(file.gcount()) / sizeof(wchar_t));
+
+    if (!buffer_.empty() && buffer_[0] == UTF16LE_BOM) {
+        position_ = 1;
     }
 }
 
@@ -102,119 +70,80 @@ Utf16Reader::~Utf16Reader()
 
 bool Utf16Reader::getline(std::wstring& line)
 {
-    line.clear();
-    wchar_t ch;
-    bool found_data = false;
-
-    while (ReadChar(ch)) {
-        found_data = true;
-        if (ch == L'\n') {
-            break;
-        }
-        if (ch == L'\r') {
-            // CR encountered - check if followed by LF
-            wchar_t next;
-            if (PeekChar(next) && next == L'\n') {
-                // CRLF sequence - consume the LF
-                ReadChar(next);
-            }
-            // CR alone or CRLF - line ending (LF already consumed if present)
-            break;
+    const size_t size = buffer_.size();
+    if (position_ >= size) {
+        line.clear();
+        eof_ = true;
+        return false;
+    }
+
+    const size_t lineBreak = FindLineBreak(buffer_.data(), position_, size);
+    line.assign(buffer_, position_, lineBreak - position_);
+    position_ = lineBreak;
+
+    if (lineBreak == size) {
+        eof_ = true;
+    }
+    else if (buffer_[position_++] == L'\r') {
+        // CR alone or CRLF - line ending
+        if (position_ == size) {
+            eof_ = true;
         }
-        else {
-            line += ch;
+        else if (buffer_[position_] == L'\n') {
+            position_++;
         }
     }
-    return found_data;
+    return true;
 }
 
 bool Utf16Reader::eof() const
 {
-    return file_.eof();
+    return eof_;
 }
 
 void Utf16Reader::close()
 {
-    file_.close();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    position_ = 0;
 }
 
-bool Utf16Reader::ReadChar(wchar_t& ch)
+
+bool WriteUtf16FileAtomically(const std::filesystem::path& path, std::wstring_view text, const std::filesystem::path& replacedPath)
 {
-    file_.read(reinterpret_cast<char*>(&ch), sizeof(ch));
-    if (file_.gcount() != static_cast<std::streamsize>(sizeof(ch))) {
-        file_.setstate(std::ios::eofbit);
+    std::filesystem::path tempPath(path);
+    tempPath += L".tmp";
+
+    HANDLE file = ::CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
         return false;
     }
-    return true;
-}
-
-bool Utf16Reader::PeekChar(wchar_t& ch)
-{
-    ch = file_.peek();
-    if (ch == WEOF) {
+    // The data must be on disk before the swap, or a crash can leave an empty file behind
+    const bool isWritten = WriteAll(file, &UTF16LE_BOM, sizeof(UTF16LE_BOM))
+                        && WriteAll(file, text.data(), text.size() * sizeof(wchar_t))
+                        && ::FlushFileBuffers(file);
+    ::CloseHandle(file);
+    if (!isWritten) {
+        ::DeleteFileW(tempPath.c_str());
         return false;
     }
-    return true;
-}
-
 
-Utf16Writer::Utf16Writer(const std::filesystem::path& filename)
-    : file_(filename, std::ios::binary)
-{
-    if (!file_.is_open())
-    {
-        throw std::runtime_error("Failed to open file: " + filename.string());
-    }
-    file_.write(reinterpret_cast<const char*>(&UTF16LE_BOM), sizeof(UTF16LE_BOM));
-    if (!file_.good()) {
-        throw std::runtime_error("Failed to write BOM to file: " + filename.string());
+    if (!replacedPath.empty() && ::GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+        if (::ReplaceFileW(path.c_str(), tempPath.c_str(), replacedPath.c_str(), REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr)) {
+            return true;
+        }
+        // ReplaceFileW can fail after it moved the old file aside; only then may the new one be moved in
+        if (::GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+            ::DeleteFileW(tempPath.c_str());
+            return false;
+        }
     }
-}
-
-Utf16Writer::~Utf16Writer()
-{
-    file_.close();
-}
-
-bool Utf16Writer::is_open() const
-{
-    return file_.is_open();
-}
 
-Utf16Writer& Utf16Writer::operator<<(std::wstring_view str)
-{
-    file_.write(reinterpret_cast<const char*>(str.data()),
-                static_cast<std::streamsize>(str.length() * sizeof(wchar_t)));
-    return *this;
-}
-
-Utf16Writer& Utf16Writer::operator<<(wchar_t ch)
-{
-    file_.write(reinterpret_cast<const char*>(&ch), sizeof(ch));
-    return *this;
-}
-
-Utf16Writer& Utf16Writer::operator<<(const wchar_t* str)
-{
-    const std::wstring_view view(str);
-    file_.write(reinterpret_cast<const char*>(view.data()),
-                static_cast<std::streamsize>(view.length() * sizeof(wchar_t)));
-    return *this;
-}
-
-Utf16Writer& Utf16Writer::operator<<(uint32_t value)
-{
-    const std::wstring str = std::to_wstring(value);
-    file_.write(reinterpret_cast<const char*>(str.data()),
-                static_cast<std::streamsize>(str.length() * sizeof(wchar_t)));
-    return *this;
-}
-
-Utf16Writer& Utf16Writer::operator<<(std::string_view str)
-{
-    // Convert to UTF-16 from UTF-8
-    std::wstring converted = ConvertUtf8ToUtf16(str);
-    file_.write(reinterpret_cast<const char*>(converted.data()),
-                static_cast<std::streamsize>(converted.length() * sizeof(wchar_t)));
-    return *this;
+    // Replaces the old file in one step, so readers see either file whole
+    const DWORD flags = MOVEFILE_WRITE_THROUGH | (replacedPath.empty() ? MOVEFILE_REPLACE_EXISTING : 0);
+    if (!::MoveFileExW(tempPath.c_str(), path.c_str(), flags)) {
+        ::DeleteFileW(tempPath.c_str());
+        return false;
+    }
+    return true;
 }
@@ -1,7 +1,10 @@
 #pragma once
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <string_view>
 
+// Reads the whole file with one call and splits lines in memory
 class Utf16Reader {
 public:
     explicit Utf16Reader(const std::filesystem::path& filename);
@@ -12,25 +15,13 @@ public:
     void close();
 
 private:
-    bool ReadChar(wchar_t& ch);
-    bool PeekChar(wchar_t& ch);
-    std::ifstream file_;
+    std::wstring buffer_;
+    size_t position_ = 0;
+    bool eof_ = false;
 };
 
-class Utf16Writer
-{
-public:
-    explicit Utf16Writer(const std::filesystem::path& filename);
-    ~Utf16Writer();
-
-    bool is_open() const;
-
-    Utf16Writer& operator<<(std::wstring_view str);
-    Utf16Writer& operator<<(std::string_view str);
-    Utf16Writer& operator<<(const wchar_t* str);
-    Utf16Writer& operator<<(wchar_t ch);
-    Utf16Writer& operator<<(uint32_t value);
-
-private:
-    std::ofstream file_;
-};
+// Writes text with a byte order mark to a temporary file next to path and
+// swaps it in only once it is on disk, so a crash leaves the old or the new
+// file whole. With replacedPath the old file is moved there by the same swap,
+// and the write fails rather than overwrite a file it could not move aside.
+bool WriteUtf16FileAtomically(const std::filesystem::path& path, std::wstring_view text, const std::filesystem::path& replacedPath = {});
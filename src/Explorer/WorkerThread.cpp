@@ -22,6 +22,29 @@
 
 #include "WorkerThread.h"
 #include <objbase.h>
+#include <algorithm>
+
+namespace {
+
+// How long a queued task may wait before it is allowed to overtake tasks of a
+// more relevant level. Visible work never waits, speculative work never ages,
+// so the visible page stays fast no matter how much background work is queued.
+constexpr std::chrono::milliseconds NEAR_VISIBLE_DEADLINE{150};
+constexpr std::chrono::milliseconds BACKGROUND_DEADLINE{2000};
+
+std::optional<std::chrono::steady_clock::time_point> DeadlineOf(TaskPriority priority, std::chrono::steady_clock::time_point enqueued)
+{
+    switch (priority) {
+    case TaskPriority::NearVisible:
+        return enqueued + NEAR_VISIBLE_DEADLINE;
+    case TaskPriority::Background:
+        return enqueued + BACKGROUND_DEADLINE;
+    default:
+        return std::nullopt;
+    }
+}
+
+} // namespace
 
 WorkerThread::WorkerThread()
 {
@@ -49,39 +72,115 @@ void WorkerThread::Stop()
     }
 }
 
-void WorkerThread::Enqueue(std::unique_ptr<IAsyncTask> task) {
+void WorkerThread::Enqueue(std::unique_ptr<IAsyncTask> task)
+{
+    const TaskPriority priority = task->GetPriority();
+    Enqueue(std::move(task), priority);
+}
+
+void WorkerThread::Enqueue(std::unique_ptr<IAsyncTask> task, TaskPriority priority)
+{
     {
         std::unique_lock<std::mutex> lock(_taskQueueMutex);
-        if (task->GetPriority() == TaskPriority::High) {
-            _highPriorityQueue.push_back(std::move(task));
-        } else {
-            _lowPriorityQueue.push_back(std::move(task));
-        }
+        _queues[static_cast<size_t>(priority)].push_back({ std::move(task), Clock::now() });
     }
     _taskQueueCv.notify_one();
 }
 
 void WorkerThread::ClearPendingTasks(std::optional<TaskCategory> category) {
     std::unique_lock<std::mutex> lock(_taskQueueMutex);
-    if (!category.has_value()) {
-        // No category filter: clear all tasks
-        _highPriorityQueue.clear();
-        _lowPriorityQueue.clear();
-    } else {
-        // Category filter: remove only tasks matching the given category
-        auto removeMatching = [&](std::deque<std::unique_ptr<IAsyncTask>>& queue) {
-            queue.erase(
-                std::remove_if(queue.begin(), queue.end(), [&](const std::unique_ptr<IAsyncTask>& t) {
-                    return t->GetCategory() == *category;
-                }),
-                queue.end()
-            );
-        };
-        removeMatching(_highPriorityQueue);
-        removeMatching(_lowPriorityQueue);
+    for (auto& queue : _queues) {
+        if (!category.has_value()) {
+            // No category filter: clear all tasks
+            queue.clear();
+        } else {
+            // Category filter: remove only tasks matching the given category
+            std::erase_if(queue, [&](const QueuedTask& queued) {
+                return queued.task->GetCategory() == *category;
+            });
+        }
     }
 }
 
+void WorkerThread::Reprioritize(TaskCategory category, const RankFunction& rank)
+{
+    {
+        std::unique_lock<std::mutex> lock(_taskQueueMutex);
+        std::array<TaskQueue, TASK_PRIORITY_COUNT> moved;
+        for (size_t level = 0; level < _queues.size(); ++level) {
+            auto& queue = _queues[level];
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (it->task->GetCategory() != category) {
+                    ++it;
+                    continue;
+                }
+                const auto key = it->task->GetViewKey();
+                if (!key.has_value()) {
+                    ++it;
+                    continue;
+                }
+                const auto newLevel = static_cast<size_t>(rank(*key));
+                if (newLevel == level) {
+                    ++it;
+                    continue;
+                }
+                moved[newLevel].push_back(std::move(*it));
+                it = queue.erase(it);
+            }
+        }
+        // Promoted tasks go to the front so they run before older work of the same level.
+        for (size_t level = 0; level < _queues.size(); ++level) {
+            auto& queue = _queues[level];
+            if (level <= static_cast<size_t>(TaskPriority::NearVisible)) {
+                queue.insert(queue.begin(), std::make_move_iterator(moved[level].begin()), std::make_move_iterator(moved[level].end()));
+            } else {
+                queue.insert(queue.end(), std::make_move_iterator(moved[level].begin()), std::make_move_iterator(moved[level].end()));
+            }
+        }
+    }
+    _taskQueueCv.notify_one();
+}
+
+std::unique_ptr<IAsyncTask> WorkerThread::PopNextTask()
+{
+    auto pop = [this](size_t level) {
+        auto task = std::move(_queues[level].front().task);
+        _queues[level].pop_front();
+        return task;
+    };
+
+    constexpr auto visible = static_cast<size_t>(TaskPriority::Visible);
+    if (!_queues[visible].empty()) {
+        return pop(visible);
+    }
+
+    // A task that has waited past its deadline runs before fresher work of a
+    // more relevant level, so lower levels cannot starve while the user scrolls.
+    const auto now = Clock::now();
+    std::optional<size_t> overdueLevel;
+    Clock::time_point earliest = Clock::time_point::max();
+    for (size_t level = visible + 1; level < _queues.size(); ++level) {
+        if (_queues[level].empty()) {
+            continue;
+        }
+        const auto deadline = DeadlineOf(static_cast<TaskPriority>(level), _queues[level].front().enqueued);
+        if (deadline.has_value() && *deadline <= now && *deadline < earliest) {
+            earliest = *deadline;
+            overdueLevel = level;
+        }
+    }
+    if (overdueLevel.has_value()) {
+        return pop(*overdueLevel);
+    }
+
+    for (size_t level = 0; level < _queues.size(); ++level) {
+        if (!_queues[level].empty()) {
+            return pop(level);
+        }
+    }
+    return nullptr;
+}
+
 void WorkerThread::Run() {
     // Use MTA (Multi-Threaded Apartment) for background worker thread.
     // STA requires a message loop which this thread does not run, and could
@@ -92,20 +191,14 @@ void WorkerThread::Run() {
         std::unique_ptr<IAsyncTask> task;
         {
             std::unique_lock<std::mutex> lock(_taskQueueMutex);
-            _taskQueueCv.wait(lock, [this] { 
-                return !_highPriorityQueue.empty() || !_lowPriorityQueue.empty() || !_running; 
+            _taskQueueCv.wait(lock, [this] {
+                return !_running || std::any_of(_queues.begin(), _queues.end(), [](const TaskQueue& queue) { return !queue.empty(); });
             });
             if (!_running) {
                 break;
             }
-            
-            if (!_highPriorityQueue.empty()) {
-                task = std::move(_highPriorityQueue.front());
-                _highPriorityQueue.pop_front();
-            } else if (!_lowPriorityQueue.empty()) {
-                task = std::move(_lowPriorityQueue.front());
-                _lowPriorityQueue.pop_front();
-            }
+
+            task = PopNextTask();
         }
 
         if (task) {
@@ -119,4 +212,3 @@ void WorkerThread::Run() {
 
     ::CoUninitialize();
 }
-
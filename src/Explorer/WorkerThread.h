@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <thread>
 #include <mutex>
@@ -29,15 +32,29 @@
 #include <optional>
 #include <functional>
 
+// Relevance of a task to what the user is currently looking at.
+// Lower values are dispatched first.
 enum class TaskPriority {
-    High,
-    Low
+    Visible,
+    NearVisible,
+    Background,
+    Speculative,
+};
+
+constexpr size_t TASK_PRIORITY_COUNT = 4;
+
+// Identifies the view position a task works on, e.g. a row range of the file
+// list or a single tree item. Used to re-rank queued tasks when the view scrolls.
+struct TaskViewKey {
+    intptr_t first;
+    intptr_t last;
 };
 
 enum class TaskCategory {
     General,
     TreeView,
     FileList,
+    FileListIcons,
 };
 
 class IAsyncTask {
@@ -45,8 +62,9 @@ public:
     virtual ~IAsyncTask() {}
     virtual void Execute() = 0;
     virtual void OnCompleted() = 0;
-    virtual TaskPriority GetPriority() const { return TaskPriority::Low; }
+    virtual TaskPriority GetPriority() const { return TaskPriority::Background; }
     virtual TaskCategory GetCategory() const { return TaskCategory::General; }
+    virtual std::optional<TaskViewKey> GetViewKey() const { return std::nullopt; }
 };
 
 class IAsyncTaskCallback {
@@ -64,11 +82,26 @@ public:
     void Start(IAsyncTaskCallback* callback);
     void Stop();
     void Enqueue(std::unique_ptr<IAsyncTask> task);
+    void Enqueue(std::unique_ptr<IAsyncTask> task, TaskPriority priority);
     void ClearPendingTasks(std::optional<TaskCategory> category = std::nullopt);
 
+    // Moves queued tasks of the category to the level returned by rank.
+    // Tasks without a view key keep their current level.
+    using RankFunction = std::function<TaskPriority(const TaskViewKey&)>;
+    void Reprioritize(TaskCategory category, const RankFunction& rank);
+
 private:
-    std::deque<std::unique_ptr<IAsyncTask>> _highPriorityQueue;
-    std::deque<std::unique_ptr<IAsyncTask>> _lowPriorityQueue;
+    using Clock = std::chrono::steady_clock;
+
+    struct QueuedTask {
+        std::unique_ptr<IAsyncTask> task;
+        Clock::time_point           enqueued;
+    };
+    using TaskQueue = std::deque<QueuedTask>;
+
+    std::unique_ptr<IAsyncTask> PopNextTask();
+
+    std::array<TaskQueue, TASK_PRIORITY_COUNT> _queues;
     std::mutex              _taskQueueMutex;
     std::condition_variable _taskQueueCv;
     std::thread             _thread;
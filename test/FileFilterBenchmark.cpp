@@ -0,0 +1,228 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Standalone benchmark of FileFilter::match against the wildcard matcher it
+// replaced, on 100k generated names. Both must agree on every name. Build
+// with optimizations and run from the repository root on any host; test/win32
+// stands in for the few Win32 types FileFilter uses:
+//
+//   g++ -std=c++20 -O2 -Itest/win32 -Isrc/Explorer test/FileFilterBenchmark.cpp src/Explorer/FileFilter.cpp -o FileFilterBenchmark && ./FileFilterBenchmark
+
+#include "FileFilter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cwchar>
+#include <cwctype>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t NAME_COUNT = 100000;
+constexpr int ROUNDS = 10;
+
+// The filter as it was before the patterns were compiled: every name is
+// compared with every pattern, folding each character on the way.
+class LegacyFilter {
+public:
+    explicit LegacyFilter(std::wstring_view filter)
+        : _filterString(filter.empty() ? L"*.*" : filter)
+    {
+        const size_t denyBegin = _filterString.find(L"[^");
+        if (denyBegin == std::wstring::npos) {
+            _allowList = Split(_filterString);
+        }
+        else {
+            const size_t denyEnd = _filterString.find(L']', denyBegin);
+            _allowList = Split(_filterString.substr(0, denyBegin));
+            _denyList = Split(_filterString.substr(denyBegin + 2, (denyEnd == std::wstring::npos) ? std::wstring::npos : denyEnd - denyBegin - 2));
+        }
+        if (_allowList.empty()) {
+            _allowList.emplace_back(L"*.*");
+        }
+    }
+
+    bool match(const std::wstring& fileName) const
+    {
+        if (fileName.empty()) {
+            return false;
+        }
+        if (_filterString == L"*.*") {
+            return true;
+        }
+        for (const auto& deny : _denyList) {
+            if (WildCompare(deny.c_str(), fileName.c_str())) {
+                return false;
+            }
+        }
+        for (const auto& allow : _allowList) {
+            if (WildCompare(allow.c_str(), fileName.c_str())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static std::vector<std::wstring> Split(std::wstring_view text)
+    {
+        std::vector<std::wstring> result;
+        size_t begin = 0;
+        while (begin <= text.size()) {
+            size_t end = text.find(L';', begin);
+            if (end == std::wstring_view::npos) {
+                end = text.size();
+            }
+            std::wstring_view item = text.substr(begin, end - begin);
+            while (!item.empty() && (item.front() == L' ' || item.front() == L'\t')) {
+                item.remove_prefix(1);
+            }
+            while (!item.empty() && (item.back() == L' ' || item.back() == L'\t')) {
+                item.remove_suffix(1);
+            }
+            if (!item.empty()) {
+                result.emplace_back(item);
+            }
+            begin = end + 1;
+        }
+        return result;
+    }
+
+    // Written by Jack Handy, see http://www.codeproject.com/string/wildcmp.asp
+    static bool WildCompare(const wchar_t* wild, const wchar_t* string)
+    {
+        const wchar_t* cp = nullptr;
+        const wchar_t* mp = nullptr;
+
+        while (*string && *wild != L'*') {
+            if (std::towlower(*wild) != std::towlower(*string) && *wild != L'?') {
+                return false;
+            }
+            wild++;
+            string++;
+        }
+        while (*string) {
+            if (*wild == L'*') {
+                if (!*++wild) {
+                    return true;
+                }
+                mp = wild;
+                cp = string + 1;
+            }
+            else if (std::towlower(*wild) == std::towlower(*string) || *wild == L'?') {
+                wild++;
+                string++;
+            }
+            else {
+                wild = mp;
+                string = cp++;
+            }
+        }
+        while (*wild == L'*') {
+            wild++;
+        }
+        return !*wild;
+    }
+
+    std::wstring _filterString;
+    std::vector<std::wstring> _allowList;
+    std::vector<std::wstring> _denyList;
+};
+
+// A source tree: mostly code and build output, in mixed case
+std::vector<std::wstring> MakeNames()
+{
+    static constexpr const wchar_t* STEMS[] = { L"main", L"FileList", L"explorer_dialog", L"README", L"test_parser", L"Settings", L"resource", L"CMakeLists" };
+    static constexpr const wchar_t* EXTENSIONS[] = { L".cpp", L".h", L".hpp", L".obj", L".pdb", L".TXT", L".md", L".json", L".xml", L".Cpp", L".bak", L"" };
+
+    std::vector<std::wstring> names;
+    names.reserve(NAME_COUNT);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < NAME_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        const wchar_t* stem = STEMS[(seed >> 8) % std::size(STEMS)];
+        const wchar_t* extension = EXTENSIONS[(seed >> 16) % std::size(EXTENSIONS)];
+        names.push_back(std::wstring(stem) + L"_" + std::to_wstring(i) + extension);
+    }
+    return names;
+}
+
+template <typename Match>
+double MeasureMilliseconds(const std::vector<std::wstring>& names, Match&& match, size_t& matched)
+{
+    matched = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const auto& name : names) {
+            matched += match(name) ? 1 : 0;
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / ROUNDS;
+}
+
+} // namespace
+
+int main()
+{
+    static constexpr const wchar_t* FILTERS[] = {
+        L"*.cpp;*.h",
+        L"*.cpp;*.h;*.hpp;*.c;*.txt;*.md;*.json;*.xml",
+        L"*.*[^*.obj;*.pdb;*.bak]",
+        L"*.cpp;*.h[^test_*]",
+        L"*_1?.*;main*",
+        L"*.*",
+    };
+
+    const std::vector<std::wstring> names = MakeNames();
+    std::printf("%zu names, mean of %d rounds\n\n", names.size(), ROUNDS);
+    std::printf("%-48s %8s %10s %10s %8s\n", "filter", "matches", "legacy ms", "ms", "speedup");
+
+    int mismatches = 0;
+    for (const wchar_t* text : FILTERS) {
+        const LegacyFilter legacy(text);
+        FileFilter filter;
+        filter.setFilter(text);
+
+        for (const auto& name : names) {
+            if (legacy.match(name) != (filter.match(L"C:\\src", name) != FALSE)) {
+                std::printf("mismatch: %ls on %ls\n", text, name.c_str());
+                mismatches++;
+                break;
+            }
+        }
+
+        size_t legacyMatched = 0;
+        size_t matched = 0;
+        const double legacyMs = MeasureMilliseconds(names, [&](const std::wstring& name) { return legacy.match(name); }, legacyMatched);
+        const double ms = MeasureMilliseconds(names, [&](const std::wstring& name) { return filter.match(L"C:\\src", name) != FALSE; }, matched);
+        if (legacyMatched != matched) {
+            mismatches++;
+        }
+        const std::string label(text, text + std::wcslen(text));
+        std::printf("%-48s %8zu %10.2f %10.2f %7.1fx\n", label.c_str(), matched / ROUNDS, legacyMs, ms, legacyMs / ms);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Standalone test of IniDocument's in-memory model; Load and Save need Win32
+// and are not covered. Build and run from the repository root on any host:
+//
+//   g++ -std=c++20 -Isrc/Explorer test/IniDocumentTest.cpp src/Explorer/IniDocument.cpp -o IniDocumentTest && ./IniDocumentTest
+
+#include "IniDocument.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* expression, int line)
+{
+    if (!condition) {
+        std::printf("line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(expression) Check((expression), #expression, __LINE__)
+
+void TestParseAndSerialize()
+{
+    const std::wstring text =
+        L"; leading comment\r\n"
+        L"[Explorer]\r\n"
+        L"LastPath=C:\\work\r\n"
+        L"  SplitterPos = 120  \r\n"
+        L"\r\n"
+        L"[Filter History]\r\n"
+        L"0=*.cpp;*.h\r\n";
+
+    IniDocument ini;
+    ini.Parse(text);
+    CHECK(ini.GetString(L"Explorer", L"LastPath", L"") == L"C:\\work");
+    CHECK(ini.GetInt(L"Explorer", L"SplitterPos", 0) == 120);
+    CHECK(ini.GetString(L"Filter History", L"0", L"") == L"*.cpp;*.h");
+
+    // Spaces around keys and values are trimmed; everything else survives
+    const std::wstring serialized = ini.Serialize();
+    CHECK(serialized ==
+        L"; leading comment\r\n"
+        L"[Explorer]\r\n"
+        L"LastPath=C:\\work\r\n"
+        L"SplitterPos=120\r\n"
+        L"\r\n"
+        L"[Filter History]\r\n"
+        L"0=*.cpp;*.h\r\n");
+
+    IniDocument reparsed;
+    reparsed.Parse(serialized);
+    CHECK(reparsed.Serialize() == serialized);
+
+    // LF line ends are read as well and written as CRLF
+    IniDocument lfOnly;
+    lfOnly.Parse(L"[A]\nkey=value\n");
+    CHECK(lfOnly.Serialize() == L"[A]\r\nkey=value\r\n");
+}
+
+void TestLookup()
+{
+    IniDocument ini;
+    ini.Parse(L"[Explorer]\r\nShowHidden=1\r\nName=\"quoted value\"\r\nSingle='x'\r\nOdd=\"open\r\n");
+
+    // Sections and keys match without regard to case
+    CHECK(ini.GetBool(L"explorer", L"SHOWHIDDEN", false));
+    CHECK(ini.Find(L"Explorer", L"Missing") == std::nullopt);
+    CHECK(ini.Find(L"Missing", L"ShowHidden") == std::nullopt);
+    CHECK(ini.GetString(L"Explorer", L"Missing", L"default") == L"default");
+
+    // Matching quotes are dropped by GetString only
+    CHECK(ini.GetString(L"Explorer", L"Name", L"") == L"quoted value");
+    CHECK(ini.Find(L"Explorer", L"Name") == L"\"quoted value\"");
+    CHECK(ini.GetString(L"Explorer", L"Single", L"") == L"x");
+    CHECK(ini.GetString(L"Explorer", L"Odd", L"") == L"\"open");
+}
+
+void TestGetInt()
+{
+    IniDocument ini;
+    ini.Parse(
+        L"[N]\r\n"
+        L"plain=42\r\n"
+        L"negative=-7\r\n"
+        L"plus=+5\r\n"
+        L"trailing=12px\r\n"
+        L"text=abc\r\n"
+        L"sign=-\r\n"
+        L"empty=\r\n"
+        L"big=99999999999\r\n"
+        L"small=-99999999999\r\n");
+
+    CHECK(ini.GetInt(L"N", L"plain", 0) == 42);
+    CHECK(ini.GetInt(L"N", L"negative", 0) == -7);
+    CHECK(ini.GetInt(L"N", L"plus", 0) == 5);
+    CHECK(ini.GetInt(L"N", L"trailing", 0) == 12);
+    CHECK(ini.GetInt(L"N", L"text", 3) == 3);
+    CHECK(ini.GetInt(L"N", L"sign", 3) == 3);
+    CHECK(ini.GetInt(L"N", L"empty", 3) == 3);
+    CHECK(ini.GetInt(L"N", L"big", 0) == 2147483647);
+    CHECK(ini.GetInt(L"N", L"small", 0) == -2147483647 - 1);
+    CHECK(ini.GetInt(L"N", L"missing", 9) == 9);
+    CHECK(ini.GetBool(L"N", L"text", true));
+    CHECK(!ini.GetBool(L"N", L"missing", false));
+}
+
+void TestSetRoundTrip()
+{
+    IniDocument ini;
+    ini.Parse(L"; header\r\n[Explorer]\r\nLastPath=C:\\\r\n\r\n[Other]\r\nkeep=1\r\n");
+
+    ini.SetString(L"explorer", L"lastpath", L"D:\\projects");
+    ini.SetInt(L"Explorer", L"SortPos", -3);
+    ini.SetBool(L"Explorer", L"UseFullTree", true);
+    ini.SetString(L"New", L"key", L"value with = sign");
+
+    // Existing keys keep their place and spelling, new keys go before trailing
+    // blank lines, new sections go last
+    const std::wstring serialized = ini.Serialize();
+    CHECK(serialized ==
+        L"; header\r\n"
+        L"[Explorer]\r\n"
+        L"LastPath=D:\\projects\r\n"
+        L"SortPos=-3\r\n"
+        L"UseFullTree=1\r\n"
+        L"\r\n"
+        L"[Other]\r\n"
+        L"keep=1\r\n"
+        L"[New]\r\n"
+        L"key=value with = sign\r\n");
+
+    IniDocument reparsed;
+    reparsed.Parse(serialized);
+    CHECK(reparsed.GetString(L"Explorer", L"LastPath", L"") == L"D:\\projects");
+    CHECK(reparsed.GetInt(L"Explorer", L"SortPos", 0) == -3);
+    CHECK(reparsed.GetBool(L"Explorer", L"UseFullTree", false));
+    CHECK(reparsed.GetString(L"New", L"key", L"") == L"value with = sign");
+    CHECK(reparsed.GetInt(L"Other", L"keep", 0) == 1);
+}
+
+void TestClearSection()
+{
+    IniDocument ini;
+    ini.Parse(L"[History]\r\n; recent filters\r\n0=*.cpp\r\n1=*.h\r\n[Explorer]\r\n0=stays\r\n");
+
+    ini.ClearSection(L"history");
+    ini.SetString(L"History", L"0", L"*.txt");
+    CHECK(ini.Find(L"History", L"1") == std::nullopt);
+    CHECK(ini.GetString(L"Explorer", L"0", L"") == L"stays");
+    CHECK(ini.Serialize() == L"[History]\r\n; recent filters\r\n0=*.txt\r\n[Explorer]\r\n0=stays\r\n");
+}
+
+void TestMalformedLines()
+{
+    IniDocument ini;
+    ini.Parse(
+        L"orphan=before any section\r\n"
+        L"[Broken\r\n"
+        L"no equal sign\r\n"
+        L"=no key\r\n"
+        L"; key=commented out\r\n"
+        L"[ Spaced ]\r\n"
+        L"dup=first\r\n"
+        L"DUP=second\r\n"
+        L"[]\r\n"
+        L"in empty=1");
+
+    // Keys before the first section belong to no section and cannot be looked up
+    CHECK(ini.Find(L"", L"orphan") == std::nullopt);
+
+    // An unterminated section header still opens the section
+    CHECK(ini.Find(L"Broken", L"no equal sign") == std::nullopt);
+    CHECK(ini.Find(L"Broken", L"") == std::nullopt);
+    CHECK(ini.Find(L"Broken", L"; key") == std::nullopt);
+
+    // Section names are trimmed, the first of duplicate keys wins
+    CHECK(ini.GetString(L"Spaced", L"dup", L"") == L"first");
+
+    // Lines that are not pairs are written back as they were read
+    const std::wstring serialized = ini.Serialize();
+    CHECK(serialized ==
+        L"orphan=before any section\r\n"
+        L"[Broken]\r\n"
+        L"no equal sign\r\n"
+        L"=no key\r\n"
+        L"; key=commented out\r\n"
+        L"[Spaced]\r\n"
+        L"dup=first\r\n"
+        L"DUP=second\r\n"
+        L"in empty=1\r\n");
+
+    // Setting a key updates the first duplicate only
+    ini.SetString(L"Spaced", L"Dup", L"changed");
+    CHECK(ini.GetString(L"Spaced", L"dup", L"") == L"changed");
+    CHECK(ini.Serialize().find(L"DUP=second\r\n") != std::wstring::npos);
+
+    IniDocument empty;
+    empty.Parse(L"");
+    CHECK(empty.Serialize().empty());
+}
+
+} // namespace
+
+int main()
+{
+    TestParseAndSerialize();
+    TestLookup();
+    TestGetInt();
+    TestSetRoundTrip();
+    TestClearSection();
+    TestMalformedLines();
+
+    if (failures != 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,40 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2026 funap
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// The few Win32 types and macros that FileFilter uses, so that the host-side
+// benchmarks in test/ build with g++ on any host. Never put this folder on
+// the include path of the plugin itself.
+
+#pragma once
+
+#include <cstddef>
+
+typedef wchar_t         WCHAR;
+typedef int             BOOL;
+typedef size_t          SIZE_T;
+typedef const wchar_t*  LPCWSTR;
+typedef const wchar_t*  LPCTSTR;
+
+#define TRUE            1
+#define FALSE           0
+#define MAX_PATH        260
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))